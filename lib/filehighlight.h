@@ -16,6 +16,9 @@ typedef struct mc_fhl_struct
 {
     mc_config_t *config;
     GPtrArray *filters;
+    GHashTable *extensions;     /* extension -> index of the first filter + 1 */
+    GHashTable *extensions_nocase;      /* the same for lowercased extensions */
+    guint id;                   /* identifier of rules set, never 0 */
 } mc_fhl_t;
 
 /*** global variables defined in .c file *********************************************************/
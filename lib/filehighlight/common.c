@@ -38,6 +38,8 @@
 
 /*** file scope variables ************************************************************************/
 
+static guint mc_fhl_last_id = 0;
+
 /*** file scope functions ************************************************************************/
 
 static void
@@ -61,6 +63,29 @@ mc_fhl_array_free (mc_fhl_t * fhl)
         g_ptr_array_foreach (fhl->filters, (GFunc) mc_fhl_filter_free, NULL);
         fhl->filters = (GPtrArray *) g_ptr_array_free (fhl->filters, TRUE);
     }
+
+    if (fhl->extensions != NULL)
+    {
+        g_hash_table_destroy (fhl->extensions);
+        fhl->extensions = NULL;
+        g_hash_table_destroy (fhl->extensions_nocase);
+        fhl->extensions_nocase = NULL;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get identifier for the new set of rules. Colors cached in file entries by
+ * mc_fhl_get_color() are valid only for rules with the same identifier.
+ */
+
+guint
+mc_fhl_new_id (void)
+{
+    if (++mc_fhl_last_id == 0)
+        mc_fhl_last_id = 1;
+
+    return mc_fhl_last_id;
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -76,6 +101,8 @@ mc_fhl_new (gboolean need_auto_fill)
     if (fhl == NULL)
         return NULL;
 
+    fhl->id = mc_fhl_new_id ();
+
     if (!need_auto_fill)
         return fhl;
 
@@ -152,82 +152,95 @@ mc_fhl_is_special (file_entry_t * fe)
          || mc_fhl_is_special_door (fe));
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get all file types of entry at once.
+ *
+ * @param fe file entry
+ *
+ * @return bit mask of mc_flhgh_ftype_type values
+ */
+
+static guint
+mc_fhl_get_file_types (file_entry_t * fe)
+{
+    guint types = 0;
+
+    if (mc_fhl_is_file (fe))
+    {
+        types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_FILE);
+        if (mc_fhl_is_file_exec (fe))
+            types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_FILE_EXE);
+    }
+    if (mc_fhl_is_dir (fe) || mc_fhl_is_link_to_dir (fe))
+        types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_DIR);
+    if (mc_fhl_is_link_to_dir (fe))
+        types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_LINK_DIR);
+    if (mc_fhl_is_link (fe) || mc_fhl_is_hlink (fe))
+        types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_LINK);
+    if (mc_fhl_is_hlink (fe))
+        types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_HARDLINK);
+    if (mc_fhl_is_link (fe))
+        types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_SYMLINK);
+    if (mc_fhl_is_stale_link (fe))
+        types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_STALE_LINK);
+    if (mc_fhl_is_device_char (fe))
+        types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_DEVICE)
+            | MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_DEVICE_CHAR);
+    if (mc_fhl_is_device_block (fe))
+        types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_DEVICE)
+            | MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_DEVICE_BLOCK);
+    if (mc_fhl_is_special (fe))
+        types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_SPECIAL);
+    if (mc_fhl_is_special_socket (fe))
+        types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_SPECIAL_SOCKET);
+    if (mc_fhl_is_special_fifo (fe))
+        types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_SPECIAL_FIFO);
+    if (mc_fhl_is_special_door (fe))
+        types |= MC_FHL_FTYPE_BIT (MC_FLHGH_FTYPE_T_SPECIAL_DOOR);
+
+    return types;
+}
 
 /* --------------------------------------------------------------------------------------------- */
+/**
+ * Find the first extension filter matched the file name.
+ * Extension can contain dots, so every part of name after a dot is looked up.
+ *
+ * @param fhl file highlight rules
+ * @param fname file name
+ *
+ * @return index of filter or G_MAXUINT if none is matched
+ */
 
-static int
-mc_fhl_get_color_filetype (mc_fhl_filter_t * mc_filter, mc_fhl_t * fhl, file_entry_t * fe)
+static guint
+mc_fhl_get_extension_filter (mc_fhl_t * fhl, const char *fname)
 {
-    gboolean my_color = FALSE;
-    (void) fhl;
+    guint ret = G_MAXUINT;
+    const char *ext;
 
-    switch (mc_filter->file_type)
+    if (fhl->extensions == NULL)
+        return ret;
+
+    for (ext = strchr (fname, '.'); ext != NULL; ext = strchr (ext, '.'))
     {
-    case MC_FLHGH_FTYPE_T_FILE:
-        if (mc_fhl_is_file (fe))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_FILE_EXE:
-        if ((mc_fhl_is_file (fe)) && (mc_fhl_is_file_exec (fe)))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_DIR:
-        if (mc_fhl_is_dir (fe) || mc_fhl_is_link_to_dir (fe))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_LINK_DIR:
-        if (mc_fhl_is_link_to_dir (fe))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_LINK:
-        if ((mc_fhl_is_link (fe)) || (mc_fhl_is_hlink (fe)))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_HARDLINK:
-        if (mc_fhl_is_hlink (fe))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_SYMLINK:
-        if (mc_fhl_is_link (fe))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_STALE_LINK:
-        if (mc_fhl_is_stale_link (fe))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_DEVICE:
-        if ((mc_fhl_is_device_char (fe)) || (mc_fhl_is_device_block (fe)))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_DEVICE_BLOCK:
-        if (mc_fhl_is_device_block (fe))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_DEVICE_CHAR:
-        if (mc_fhl_is_device_char (fe))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_SPECIAL:
-        if (mc_fhl_is_special (fe))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_SPECIAL_SOCKET:
-        if (mc_fhl_is_special_socket (fe))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_SPECIAL_FIFO:
-        if (mc_fhl_is_special_fifo (fe))
-            my_color = TRUE;
-        break;
-    case MC_FLHGH_FTYPE_T_SPECIAL_DOOR:
-        if (mc_fhl_is_special_door (fe))
-            my_color = TRUE;
-        break;
-    default:
-        break;
+        guint idx;
+        char *lc_ext;
+
+        ext++;
+
+        idx = GPOINTER_TO_UINT (g_hash_table_lookup (fhl->extensions, ext));
+        if (idx != 0 && idx - 1 < ret)
+            ret = idx - 1;
+
+        lc_ext = g_ascii_strdown (ext, -1);
+        idx = GPOINTER_TO_UINT (g_hash_table_lookup (fhl->extensions_nocase, lc_ext));
+        if (idx != 0 && idx - 1 < ret)
+            ret = idx - 1;
+        g_free (lc_ext);
     }
 
-    return (my_color) ? mc_filter->color_pair_index : -1;
+    return ret;
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -239,7 +252,7 @@ mc_fhl_get_color_regexp (mc_fhl_filter_t * mc_filter, mc_fhl_t * fhl, file_entry
     if (mc_filter->search_condition == NULL)
         return -1;
 
-    if (mc_search_run (mc_filter->search_condition, fe->fname, 0, strlen (fe->fname), NULL))
+    if (mc_search_run (mc_filter->search_condition, fe->fname, 0, fe->fnamelen, NULL))
         return mc_filter->color_pair_index;
 
     return -1;
@@ -247,32 +260,31 @@ mc_fhl_get_color_regexp (mc_fhl_filter_t * mc_filter, mc_fhl_t * fhl, file_entry
 
 /* --------------------------------------------------------------------------------------------- */
 
-/* --------------------------------------------------------------------------------------------- */
-/*** public functions ****************************************************************************/
-/* --------------------------------------------------------------------------------------------- */
-
-int
-mc_fhl_get_color (mc_fhl_t * fhl, file_entry_t * fe)
+static int
+mc_fhl_compute_color (mc_fhl_t * fhl, file_entry_t * fe)
 {
-    guint i;
-    int ret;
+    guint i, types, ext_filter;
 
-    if (fhl == NULL)
-        return NORMAL_COLOR;
+    types = mc_fhl_get_file_types (fe);
+    ext_filter = mc_fhl_get_extension_filter (fhl, fe->fname);
 
     for (i = 0; i < fhl->filters->len; i++)
     {
         mc_fhl_filter_t *mc_filter;
+        int ret;
 
         mc_filter = (mc_fhl_filter_t *) g_ptr_array_index (fhl->filters, i);
         switch (mc_filter->type)
         {
         case MC_FLHGH_T_FTYPE:
-            ret = mc_fhl_get_color_filetype (mc_filter, fhl, fe);
-            if (ret > 0)
-                return -ret;
+            if (mc_filter->color_pair_index > 0
+                && (types & MC_FHL_FTYPE_BIT (mc_filter->file_type)) != 0)
+                return -mc_filter->color_pair_index;
             break;
         case MC_FLHGH_T_EXT:
+            if (i == ext_filter)
+                return -mc_filter->color_pair_index;
+            break;
         case MC_FLHGH_T_FREGEXP:
             ret = mc_fhl_get_color_regexp (mc_filter, fhl, fe);
             if (ret > 0)
@@ -286,3 +298,31 @@ mc_fhl_get_color (mc_fhl_t * fhl, file_entry_t * fe)
 }
 
 /* --------------------------------------------------------------------------------------------- */
+/*** public functions ****************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get color of file. Color is computed once and kept in the file entry until
+ * the entry or the rules are changed.
+ *
+ * @param fhl file highlight rules
+ * @param fe file entry
+ *
+ * @return color pair index
+ */
+
+int
+mc_fhl_get_color (mc_fhl_t * fhl, file_entry_t * fe)
+{
+    if (fhl == NULL)
+        return NORMAL_COLOR;
+
+    if (fe->fhl_id != fhl->id)
+    {
+        fe->fhl_color = mc_fhl_compute_color (fhl, fe);
+        fe->fhl_id = fhl->id;
+    }
+
+    return fe->fhl_color;
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -29,7 +29,6 @@
 
 #include "lib/global.h"
 #include "lib/fileloc.h"
-#include "lib/strescape.h"
 #include "lib/skin.h"
 #include "lib/util.h"           /* exist_file() */
 #include "lib/filehighlight.h"
@@ -125,12 +124,19 @@ mc_fhl_parse_get_regexp (mc_fhl_t * fhl, const gchar * group_name)
 
 /* --------------------------------------------------------------------------------------------- */
 
+/**
+ * Parse extensions filter. Extensions are put into hash tables of rules set,
+ * so the filter is found by lookup of extensions of file name instead of
+ * matching the name against every filter.
+ */
+
 static gboolean
 mc_fhl_parse_get_extensions (mc_fhl_t * fhl, const gchar * group_name)
 {
     mc_fhl_filter_t *mc_filter;
     gchar **exts, **exts_orig;
-    GString *buf;
+    GHashTable *table;
+    gpointer idx;
 
     exts_orig = mc_config_get_string_list (fhl->config, group_name, "extensions", NULL);
     if (exts_orig == NULL || exts_orig[0] == NULL)
@@ -139,33 +145,42 @@ mc_fhl_parse_get_extensions (mc_fhl_t * fhl, const gchar * group_name)
         return FALSE;
     }
 
-    buf = g_string_sized_new (64);
+    mc_filter = g_new0 (mc_fhl_filter_t, 1);
+    mc_filter->type = MC_FLHGH_T_EXT;
+    mc_fhl_parse_fill_color_info (mc_filter, fhl, group_name);
+    g_ptr_array_add (fhl->filters, (gpointer) mc_filter);
 
-    for (exts = exts_orig; *exts != NULL; exts++)
+    /* filter without color is never matched */
+    if (mc_filter->color_pair_index <= 0)
     {
-        char *esc_ext;
-
-        esc_ext = strutils_regex_escape (*exts);
-        if (buf->len != 0)
-            g_string_append_c (buf, '|');
-        g_string_append (buf, esc_ext);
-        g_free (esc_ext);
+        g_strfreev (exts_orig);
+        return TRUE;
     }
-    g_strfreev (exts_orig);
 
-    g_string_prepend (buf, ".*\\.(");
-    g_string_append (buf, ")$");
+    if (mc_config_get_bool (fhl->config, group_name, "extensions_case", TRUE))
+        table = fhl->extensions;
+    else
+        table = fhl->extensions_nocase;
 
-    mc_filter = g_new0 (mc_fhl_filter_t, 1);
-    mc_filter->type = MC_FLHGH_T_FREGEXP;
-    mc_filter->search_condition = mc_search_new (buf->str, buf->len, DEFAULT_CHARSET);
-    mc_filter->search_condition->is_case_sensitive =
-        mc_config_get_bool (fhl->config, group_name, "extensions_case", TRUE);
-    mc_filter->search_condition->search_type = MC_SEARCH_T_REGEX;
+    idx = GUINT_TO_POINTER (fhl->filters->len);
+
+    for (exts = exts_orig; *exts != NULL; exts++)
+    {
+        char *ext;
+
+        if (table == fhl->extensions)
+            ext = g_strdup (*exts);
+        else
+            ext = g_ascii_strdown (*exts, -1);
+
+        /* the first filter wins */
+        if (g_hash_table_lookup (table, ext) == NULL)
+            g_hash_table_insert (table, ext, idx);
+        else
+            g_free (ext);
+    }
+    g_strfreev (exts_orig);
 
-    mc_fhl_parse_fill_color_info (mc_filter, fhl, group_name);
-    g_ptr_array_add (fhl->filters, (gpointer) mc_filter);
-    g_string_free (buf, TRUE);
     return TRUE;
 }
 
@@ -225,6 +240,9 @@ mc_fhl_parse_ini_file (mc_fhl_t * fhl)
 
     mc_fhl_array_free (fhl);
     fhl->filters = g_ptr_array_new ();
+    fhl->extensions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    fhl->extensions_nocase = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    fhl->id = mc_fhl_new_id ();
 
     orig_group_names = mc_config_get_groups (fhl->config, NULL);
     ok = (*orig_group_names != NULL);
@@ -3,6 +3,8 @@
 
 /*** typedefs(not structures) and defined constants **********************************************/
 
+#define MC_FHL_FTYPE_BIT(t) (1U << (t))
+
 /*** enums ***************************************************************************************/
 
 typedef enum
@@ -50,6 +52,7 @@ typedef struct mc_fhl_filter_struct
 /*** declarations of public functions ************************************************************/
 
 void mc_fhl_array_free (mc_fhl_t *);
+guint mc_fhl_new_id (void);
 
 gboolean mc_fhl_init_from_standard_files (mc_fhl_t *);
 
@@ -59,6 +59,8 @@
 #define MC_HOTLIST_FILE         "hotlist"
 #define MC_USERMENU_FILE        "menu"
 #define MC_TREESTORE_FILE       "Tree"
+#define MC_DIRSIZE_FILE         "dirsize"
+#define MC_COPY_JOURNAL_FILE    "copyjournal-"
 #define MC_PANELS_FILE          "panels.ini"
 #define MC_FHL_INI_FILE         "filehighlight.ini"
 #define MC_SKINS_SUBDIR         "skins"
@@ -106,7 +106,8 @@ mc_global_t mc_global = {
         .ugly_line_drawing = FALSE,
         .old_mouse = FALSE,
         .alternate_plus_minus = FALSE,
-        .winch_flag = 0
+        .winch_flag = 0,
+        .max_fps = 30
     },
 
     .vfs =
@@ -283,6 +283,9 @@ typedef struct
 
         /* Set if the window has changed it's size */
         SIG_ATOMIC_VOLATILE_T winch_flag;
+
+        /* Max number of screen refreshes per second, 0 means unlimited */
+        int max_fps;
     } tty;
 
     struct
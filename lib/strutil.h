@@ -181,6 +181,7 @@ GIConv str_crt_conv_to (const char *);
 
 /* close convertor, do not close str_cnv_to_term, str_cnv_from_term, 
  * str_cnv_not_convert 
+ * convertors created by str_crt_conv_from() and str_crt_conv_to() are kept to be reused
  */
 void str_close_conv (GIConv);
 
@@ -41,8 +41,35 @@ GIConv str_cnv_not_convert = INVALID_CONV;
 
 /*** file scope macro definitions ****************************************************************/
 
+/* max length of converted byte kept in the table of converter */
+#define STR_CONV_TABLE_CHAR_LEN 7
+
+/* byte cannot be converted */
+#define STR_CONV_TABLE_INVALID 0xFF
+
 /*** file scope type declarations ****************************************************************/
 
+typedef enum
+{
+    STR_CONV_TABLE_NONE = 0,    /* table is not built yet */
+    STR_CONV_TABLE_READY,       /* source encoding is single-byte one, table is built */
+    STR_CONV_TABLE_UNUSABLE     /* source encoding is multibyte or stateful one */
+} str_conv_table_state_t;
+
+/* converter opened by str_crt_conv_from() or str_crt_conv_to(). It isn't closed by
+   str_close_conv() but is kept to be reused for the same pair of encodings */
+typedef struct
+{
+    GIConv conv;
+    char *to_enc;
+    char *from_enc;
+    gboolean busy;
+    str_conv_table_state_t table_state;
+    /* results of conversion of every byte of single-byte source encoding */
+    guint8 *table_len;
+    char (*table)[STR_CONV_TABLE_CHAR_LEN];
+} str_conv_t;
+
 /*** file scope variables ************************************************************************/
 
 /* names, that are used for utf-8 */
@@ -77,6 +104,8 @@ static char *codeset = NULL;
 static char *term_encoding = NULL;
 /* function for encoding specific operations */
 static struct str_class used_class;
+/* opened converters */
+static GPtrArray *str_convs = NULL;
 
 /* --------------------------------------------------------------------------------------------- */
 /*** file scope functions ************************************************************************/
@@ -91,6 +120,217 @@ str_test_not_convert (const char *enc)
 
 /* --------------------------------------------------------------------------------------------- */
 
+static str_conv_t *
+str_conv_find (GIConv coder)
+{
+    guint i;
+
+    if (str_convs != NULL && coder != INVALID_CONV)
+        for (i = 0; i < str_convs->len; i++)
+        {
+            str_conv_t *cnv = (str_conv_t *) g_ptr_array_index (str_convs, i);
+
+            if (cnv->conv == coder)
+                return cnv;
+        }
+
+    return NULL;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+str_conv_free (gpointer data)
+{
+    str_conv_t *cnv = (str_conv_t *) data;
+
+    /* converter in use will be closed by str_close_conv() */
+    if (!cnv->busy)
+        g_iconv_close (cnv->conv);
+    g_free (cnv->to_enc);
+    g_free (cnv->from_enc);
+    g_free (cnv->table_len);
+    g_free (cnv->table);
+    g_free (cnv);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get converter from one encoding to another: reuse idle one or open new.
+ *
+ * @param to_enc target encoding
+ * @param from_enc source encoding
+ *
+ * @return converter or INVALID_CONV if conversion is not supported
+ */
+
+static GIConv
+str_conv_open (const char *to_enc, const char *from_enc)
+{
+    str_conv_t *cnv;
+    GIConv conv;
+    guint i;
+
+    if (str_convs == NULL)
+        str_convs = g_ptr_array_new_with_free_func (str_conv_free);
+
+    for (i = 0; i < str_convs->len; i++)
+    {
+        cnv = (str_conv_t *) g_ptr_array_index (str_convs, i);
+
+        if (!cnv->busy && g_ascii_strcasecmp (cnv->to_enc, to_enc) == 0
+            && g_ascii_strcasecmp (cnv->from_enc, from_enc) == 0)
+        {
+            cnv->busy = TRUE;
+            g_iconv (cnv->conv, NULL, NULL, NULL, NULL);
+            return cnv->conv;
+        }
+    }
+
+    conv = g_iconv_open (to_enc, from_enc);
+    if (conv == INVALID_CONV)
+        return conv;
+
+    cnv = g_new0 (str_conv_t, 1);
+    cnv->conv = conv;
+    cnv->to_enc = g_strdup (to_enc);
+    cnv->from_enc = g_strdup (from_enc);
+    cnv->busy = TRUE;
+    g_ptr_array_add (str_convs, cnv);
+
+    return conv;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Convert every byte of source encoding and remember results.
+ * The table is used only if every byte is converted to complete character or is rejected,
+ * i.e. the source encoding is single-byte one.
+ *
+ * Some converters (CP1255, CP1258, TCVN5712-1) keep the last character until the next one
+ * comes to check whether they can be composed. Result of such converter depends on the
+ * following bytes, so its table is marked unusable.
+ */
+
+static void
+str_conv_build_table (str_conv_t * cnv)
+{
+    int c;
+
+    cnv->table_state = STR_CONV_TABLE_UNUSABLE;
+    cnv->table_len = g_new (guint8, 256);
+    cnv->table = g_malloc (256 * STR_CONV_TABLE_CHAR_LEN);
+
+    cnv->table_len[0] = STR_CONV_TABLE_INVALID;
+
+    for (c = 1; c < 256; c++)
+    {
+        char in = (char) c;
+        gchar *inbuf = &in;
+        gchar *outbuf = cnv->table[c];
+        gsize inleft = 1;
+        gsize outleft = STR_CONV_TABLE_CHAR_LEN;
+
+        g_iconv (cnv->conv, NULL, NULL, NULL, NULL);
+
+        if (g_iconv (cnv->conv, &inbuf, &inleft, &outbuf, &outleft) == (gsize) (-1))
+        {
+            if (errno != EILSEQ)
+                break;
+
+            cnv->table_len[c] = STR_CONV_TABLE_INVALID;
+            continue;
+        }
+
+        /* converter keeps the byte to compose it with the following ones,
+           so bytes cannot be converted one by one */
+        if (outleft == STR_CONV_TABLE_CHAR_LEN)
+            break;
+
+        if (g_iconv (cnv->conv, NULL, NULL, &outbuf, &outleft) == (gsize) (-1))
+            break;
+
+        cnv->table_len[c] = STR_CONV_TABLE_CHAR_LEN - outleft;
+    }
+
+    g_iconv (cnv->conv, NULL, NULL, NULL, NULL);
+
+    if (c == 256)
+        cnv->table_state = STR_CONV_TABLE_READY;
+    else
+    {
+        g_free (cnv->table_len);
+        cnv->table_len = NULL;
+        g_free (cnv->table);
+        cnv->table = NULL;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get table of converter if source encoding is single-byte one.
+ *
+ * @return converter or NULL if table cannot be used
+ */
+
+static const str_conv_t *
+str_conv_get_table (GIConv coder)
+{
+    str_conv_t *cnv;
+
+    cnv = str_conv_find (coder);
+    if (cnv == NULL)
+        return NULL;
+
+    if (cnv->table_state == STR_CONV_TABLE_NONE)
+        str_conv_build_table (cnv);
+
+    return (cnv->table_state == STR_CONV_TABLE_READY) ? cnv : NULL;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Convert string using table of converter.
+ *
+ * @return TRUE if string is converted, FALSE if the table cannot be used or string contains
+ *         byte that cannot be converted. In the last case, buffer is not changed.
+ */
+
+static gboolean
+str_conv_by_table (GIConv coder, const char *string, gsize size, GString * buffer)
+{
+    const str_conv_t *cnv;
+    gsize start, i;
+
+    cnv = str_conv_get_table (coder);
+    if (cnv == NULL)
+        return FALSE;
+
+    start = buffer->len;
+
+    for (i = 0; i < size; i++)
+    {
+        guint8 c = (guint8) string[i];
+        guint8 len = cnv->table_len[c];
+
+        if (len == STR_CONV_TABLE_INVALID)
+        {
+            /* let iconv handle the errors */
+            g_string_truncate (buffer, start);
+            return FALSE;
+        }
+
+        if (len == 1)
+            g_string_append_c (buffer, cnv->table[c][0]);
+        else
+            g_string_append_len (buffer, cnv->table[c], len);
+    }
+
+    return TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
 static estr_t
 _str_convert (GIConv coder, const char *string, int size, GString * buffer)
 {
@@ -122,6 +362,9 @@ _str_convert (GIConv coder, const char *string, int size, GString * buffer)
             size = left;
     }
 
+    if (str_conv_by_table (coder, string, (gsize) size, buffer))
+        return ESTR_SUCCESS;
+
     left = size;
     g_iconv (coder, NULL, NULL, NULL, NULL);
 
@@ -254,7 +497,7 @@ str_choose_str_functions (void)
 GIConv
 str_crt_conv_to (const char *to_enc)
 {
-    return (!str_test_not_convert (to_enc)) ? g_iconv_open (to_enc, codeset) : str_cnv_not_convert;
+    return (!str_test_not_convert (to_enc)) ? str_conv_open (to_enc, codeset) : str_cnv_not_convert;
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -263,15 +506,28 @@ GIConv
 str_crt_conv_from (const char *from_enc)
 {
     return (!str_test_not_convert (from_enc))
-        ? g_iconv_open (codeset, from_enc) : str_cnv_not_convert;
+        ? str_conv_open (codeset, from_enc) : str_cnv_not_convert;
 }
 
 /* --------------------------------------------------------------------------------------------- */
 
+/**
+ * Release converter. Converters opened by str_crt_conv_from() and str_crt_conv_to() are kept
+ * to be reused, others are closed.
+ */
+
 void
 str_close_conv (GIConv conv)
 {
-    if (conv != str_cnv_not_convert)
+    str_conv_t *cnv;
+
+    if (conv == str_cnv_not_convert)
+        return;
+
+    cnv = str_conv_find (conv);
+    if (cnv != NULL)
+        cnv->busy = FALSE;
+    else
         g_iconv_close (conv);
 }
 
@@ -350,10 +606,31 @@ str_translate_char (GIConv conv, const char *keys, size_t ch_size, char *output,
     size_t left;
     size_t cnv;
 
-    g_iconv (conv, NULL, NULL, NULL, NULL);
-
     left = (ch_size == (size_t) (-1)) ? strlen (keys) : ch_size;
 
+    if (left == 1)
+    {
+        const str_conv_t *table;
+
+        /* single byte of single-byte encoding */
+        table = str_conv_get_table (conv);
+        if (table != NULL)
+        {
+            guint8 len = table->table_len[(guint8) keys[0]];
+
+            if (len == STR_CONV_TABLE_INVALID)
+                return ESTR_FAILURE;
+            if (len < out_size)
+            {
+                memcpy (output, table->table[(guint8) keys[0]], len);
+                output[len] = '\0';
+                return ESTR_SUCCESS;
+            }
+        }
+    }
+
+    g_iconv (conv, NULL, NULL, NULL, NULL);
+
     cnv = g_iconv (conv, (gchar **) & keys, &left, &output, &out_size);
     if (cnv == (size_t) (-1))
         return (errno == EINVAL) ? ESTR_PROBLEM : ESTR_FAILURE;
@@ -423,6 +700,11 @@ str_init_strings (const char *termenc)
 void
 str_uninit_strings (void)
 {
+    if (str_convs != NULL)
+    {
+        g_ptr_array_free (str_convs, TRUE);
+        str_convs = NULL;
+    }
     if (str_cnv_not_convert != INVALID_CONV)
         g_iconv_close (str_cnv_not_convert);
     g_free (term_encoding);
@@ -38,6 +38,25 @@
 
 /*** file scope macro definitions ****************************************************************/
 
+/* classes of characters */
+#define UTF8_CHAR_PRINT     (1 << 0)
+#define UTF8_CHAR_WIDE      (1 << 1)
+#define UTF8_CHAR_COMBINING (1 << 2)
+
+/* number of characters in the table of classes: Basic Multilingual Plane */
+#define UTF8_CHAR_TABLE_SIZE 0x10000
+
+/* byte is printable ASCII character */
+#define UTF8_IS_PRINT_ASCII(c) ((c) >= 0x20 && (c) < 0x7f)
+
+/* word-at-a-time checks of bytes */
+#define UTF8_WORD_ONES  ((gsize) (-1) / 0xFF)
+#define UTF8_WORD_HIGHS (UTF8_WORD_ONES * 0x80)
+/* there is a zero byte in word */
+#define UTF8_WORD_HAS_ZERO(w) ((((w) - UTF8_WORD_ONES) & ~(w) & UTF8_WORD_HIGHS) != 0)
+/* there is a byte less than n in word which hasn't high bits */
+#define UTF8_WORD_HAS_LESS(w,n) ((((w) - UTF8_WORD_ONES * (n)) & ~(w) & UTF8_WORD_HIGHS) != 0)
+
 /*** file scope type declarations ****************************************************************/
 
 struct utf8_tool
@@ -60,18 +79,140 @@ struct term_form
 
 static const char replch[] = "\xEF\xBF\xBD";
 
+/* classes of characters of BMP, filled on first use */
+static guint8 char_table[UTF8_CHAR_TABLE_SIZE];
+static gboolean char_table_ready = FALSE;
+
 /* --------------------------------------------------------------------------------------------- */
 /*** file scope functions ************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
 
-static gboolean
-str_unichar_iscombiningmark (gunichar uni)
+static guint8
+str_unichar_compute_class (gunichar uni)
 {
     GUnicodeType type;
+    guint8 cls = 0;
+
+    if (g_unichar_isprint (uni))
+        cls |= UTF8_CHAR_PRINT;
+    if (g_unichar_iswide (uni))
+        cls |= UTF8_CHAR_WIDE;
 
     type = g_unichar_type (uni);
-    return (type == G_UNICODE_COMBINING_MARK)
-        || (type == G_UNICODE_ENCLOSING_MARK) || (type == G_UNICODE_NON_SPACING_MARK);
+    if ((type == G_UNICODE_COMBINING_MARK)
+        || (type == G_UNICODE_ENCLOSING_MARK) || (type == G_UNICODE_NON_SPACING_MARK))
+        cls |= UTF8_CHAR_COMBINING;
+
+    return cls;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get class of character. Classes of BMP characters are taken from the table,
+ * so glib tables are not looked up for every character painted on the screen.
+ */
+
+static inline guint8
+str_unichar_class (gunichar uni)
+{
+    if (uni >= UTF8_CHAR_TABLE_SIZE)
+        return str_unichar_compute_class (uni);
+
+    if (!char_table_ready)
+    {
+        gunichar c;
+
+        for (c = 0; c < UTF8_CHAR_TABLE_SIZE; c++)
+            char_table[c] = str_unichar_compute_class (c);
+
+        char_table_ready = TRUE;
+    }
+
+    return char_table[uni];
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static inline gboolean
+str_unichar_iscombiningmark (gunichar uni)
+{
+    return ((str_unichar_class (uni) & UTF8_CHAR_COMBINING) != 0);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static inline gboolean
+str_unichar_iswide (gunichar uni)
+{
+    return ((str_unichar_class (uni) & UTF8_CHAR_WIDE) != 0);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static inline gboolean
+str_unichar_isprint (gunichar uni)
+{
+    return ((str_unichar_class (uni) & UTF8_CHAR_PRINT) != 0);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get length of the leading run of printable ASCII characters.
+ * If the length of string is known, bytes are checked by words after the first aligned one.
+ * Words never go beyond @max, so a zero-terminated string is checked byte by byte.
+ *
+ * @param text string
+ * @param max max length to check, (size_t) (-1) for whole string
+ *
+ * @return number of bytes
+ */
+
+static size_t
+str_utf8_print_ascii_span (const char *text, size_t max)
+{
+    const unsigned char *p = (const unsigned char *) text;
+    size_t n = 0;
+
+    if (max != (size_t) (-1))
+    {
+        for (; n < max && ((gsize) (p + n) % sizeof (gsize)) != 0; n++)
+            if (!UTF8_IS_PRINT_ASCII (p[n]))
+                return n;
+
+        for (; max - n >= sizeof (gsize); n += sizeof (gsize))
+        {
+            gsize w;
+
+            memcpy (&w, p + n, sizeof (w));
+            if ((w & UTF8_WORD_HIGHS) != 0 || UTF8_WORD_HAS_LESS (w, 0x20)
+                || UTF8_WORD_HAS_ZERO (w ^ (UTF8_WORD_ONES * 0x7f)))
+                break;
+        }
+    }
+
+    /* zero byte is not printable */
+    for (; n < max && UTF8_IS_PRINT_ASCII (p[n]); n++)
+        ;
+
+    return n;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get length of the leading run of ASCII characters of the zero-terminated string.
+ * The length of string is unknown, so bytes are checked one by one.
+ */
+
+static size_t
+str_utf8_ascii_span (const char *text)
+{
+    const unsigned char *p = (const unsigned char *) text;
+    size_t n;
+
+    for (n = 0; p[n] != '\0' && p[n] < 0x80; n++)
+        ;
+
+    return n;
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -87,6 +228,9 @@ str_utf8_insert_replace_char (GString * buffer)
 static int
 str_utf8_is_valid_string (const char *text)
 {
+    /* ASCII is always valid */
+    text += str_utf8_ascii_span (text);
+
     return g_utf8_validate (text, -1, NULL);
 }
 
@@ -221,7 +365,7 @@ str_utf8_isprint (const char *ch)
     gunichar uni;
 
     uni = g_utf8_get_char_validated (ch, -1);
-    return g_unichar_isprint (uni);
+    return str_unichar_isprint (uni);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -466,19 +610,35 @@ str_utf8_make_make_term_form (const char *text, size_t length)
 
     while (length != 0 && text[0] != '\0')
     {
+        /* copy run of printable ASCII characters at once */
+        left = str_utf8_print_ascii_span (text, length);
+        if (left != 0)
+        {
+            memcpy (actual, text, left);
+            actual += left;
+            text += left;
+            result.width += left;
+            if (length != (size_t) (-1))
+                length -= left;
+            continue;
+        }
+
         uni = g_utf8_get_char_validated (text, -1);
         if ((uni != (gunichar) (-1)) && (uni != (gunichar) (-2)))
         {
-            if (g_unichar_isprint (uni))
+            guint8 cls;
+
+            cls = str_unichar_class (uni);
+            if ((cls & UTF8_CHAR_PRINT) != 0)
             {
                 left = g_unichar_to_utf8 (uni, actual);
                 actual += left;
-                if (str_unichar_iscombiningmark (uni))
+                if ((cls & UTF8_CHAR_COMBINING) != 0)
                     result.compose = TRUE;
                 else
                 {
                     result.width++;
-                    if (g_unichar_iswide (uni))
+                    if ((cls & UTF8_CHAR_WIDE) != 0)
                         result.width++;
                 }
             }
@@ -543,6 +703,16 @@ utf8_tool_copy_chars_to_end (struct utf8_tool *tool)
         gunichar uni;
         size_t left;
 
+        /* ASCII character is not decoded */
+        if ((unsigned char) tool->cheked[0] < 0x80)
+        {
+            if (tool->remain <= 1)
+                return FALSE;
+            *tool->actual++ = *tool->cheked++;
+            tool->remain--;
+            continue;
+        }
+
         uni = g_utf8_get_char (tool->cheked);
         tool->compose = tool->compose || str_unichar_iscombiningmark (uni);
         left = g_unichar_to_utf8 (uni, NULL);
@@ -572,13 +742,26 @@ utf8_tool_copy_chars_to (struct utf8_tool *tool, int to_ident)
         size_t left;
         int w = 0;
 
+        /* ASCII character is not decoded */
+        if ((unsigned char) tool->cheked[0] < 0x80)
+        {
+            if (tool->ident + 1 > to_ident)
+                return TRUE;
+            if (tool->remain <= 1)
+                return FALSE;
+            *tool->actual++ = *tool->cheked++;
+            tool->remain--;
+            tool->ident++;
+            continue;
+        }
+
         uni = g_utf8_get_char (tool->cheked);
         if (str_unichar_iscombiningmark (uni))
             tool->compose = TRUE;
         else
         {
             w = 1;
-            if (g_unichar_iswide (uni))
+            if (str_unichar_iswide (uni))
                 w++;
             if (tool->ident + w > to_ident)
                 return TRUE;
@@ -640,11 +823,19 @@ utf8_tool_skip_chars_to (struct utf8_tool *tool, int to_ident)
 
     while (to_ident > tool->ident && tool->cheked[0] != '\0')
     {
+        /* ASCII character is not decoded */
+        if ((unsigned char) tool->cheked[0] < 0x80)
+        {
+            tool->ident++;
+            tool->cheked++;
+            continue;
+        }
+
         uni = g_utf8_get_char (tool->cheked);
         if (!str_unichar_iscombiningmark (uni))
         {
             tool->ident++;
-            if (g_unichar_iswide (uni))
+            if (str_unichar_iswide (uni))
                 tool->ident++;
         }
         tool->cheked = g_utf8_next_char (tool->cheked);
@@ -798,6 +989,12 @@ static int
 str_utf8_term_width2 (const char *text, size_t length)
 {
     const struct term_form *result;
+    size_t n;
+
+    /* printable ASCII string is not copied */
+    n = str_utf8_print_ascii_span (text, length);
+    if (n == length || text[n] == '\0')
+        return (int) n;
 
     result = str_utf8_make_make_term_form (text, length);
     return result->width;
@@ -819,7 +1016,7 @@ str_utf8_term_char_width (const char *text)
     gunichar uni;
 
     uni = g_utf8_get_char_validated (text, -1);
-    return (str_unichar_iscombiningmark (uni)) ? 0 : ((g_unichar_iswide (uni)) ? 2 : 1);
+    return (str_unichar_iscombiningmark (uni)) ? 0 : ((str_unichar_iswide (uni)) ? 2 : 1);
 }
 
 /* --------------------------------------------------------------------------------------------- */
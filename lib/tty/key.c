@@ -1982,6 +1982,7 @@ tty_get_event (struct Gpm_Event *event, gboolean redo_event, gboolean block)
     {
         int nfd;
         fd_set select_set;
+        gboolean frame_wait = FALSE;
 
         FD_ZERO (&select_set);
         FD_SET (input_fd, &select_set);
@@ -2047,6 +2048,23 @@ tty_get_event (struct Gpm_Event *event, gboolean redo_event, gboolean block)
             time_out.tv_sec = 0;
             time_out.tv_usec = 0;
         }
+        else if (tty_refresh_is_pending ())
+        {
+            guint64 delay;
+
+            /* refresh requests were coalesced: show the last state before waiting for input */
+            delay = tty_refresh_delay ();
+            if (delay == 0)
+                tty_refresh_frame (TRUE);
+            else if (time_addr == NULL
+                     || (guint64) time_out.tv_sec * G_USEC_PER_SEC + time_out.tv_usec > delay)
+            {
+                time_out.tv_sec = 0;
+                time_out.tv_usec = (long) delay;
+                time_addr = &time_out;
+                frame_wait = TRUE;
+            }
+        }
 
         tty_enable_interrupt_key ();
         flag = select (nfd, &select_set, NULL, NULL, time_addr);
@@ -2063,7 +2081,8 @@ tty_get_event (struct Gpm_Event *event, gboolean redo_event, gboolean block)
                 return EV_MOUSE;
             if (!block || mc_global.tty.winch_flag != 0)
                 return EV_NONE;
-            vfs_timeout_handler ();
+            if (!frame_wait)
+                vfs_timeout_handler ();
         }
         if (flag == -1 && errno == EINTR)
             return EV_NONE;
@@ -41,7 +41,9 @@
 #endif
 
 #include "lib/global.h"
+#include "lib/logging.h"
 #include "lib/strutil.h"
+#include "lib/timer.h"
 
 #include "tty.h"
 #include "tty-internal.h"
@@ -67,6 +69,13 @@ int mc_tty_frm[MC_TTY_FRM_MAX];
 
 static SIG_ATOMIC_VOLATILE_T got_interrupt = 0;
 
+/* frame pacing */
+static guint64 frame_last = 0;  /* time of last refresh, 0 if screen is not refreshed yet */
+static gboolean frame_pending = FALSE;  /* refresh was requested but not done yet */
+static guint64 frame_stat_start = 0;
+static unsigned long frames_drawn = 0;
+static unsigned long frames_coalesced = 0;
+
 /*** file scope functions ************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
 
@@ -77,6 +86,25 @@ sigintr_handler (int signo)
     got_interrupt = 1;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+
+/** Log number of drawn and coalesced refreshes once per second */
+
+static void
+tty_frame_stat (guint64 now)
+{
+    if (now - frame_stat_start < G_USEC_PER_SEC)
+        return;
+
+    if (frames_coalesced != 0)
+        mc_log ("tty: %lu refreshes drawn, %lu coalesced in %.1f s\n", frames_drawn,
+                frames_coalesced, (double) (now - frame_stat_start) / G_USEC_PER_SEC);
+
+    frame_stat_start = now;
+    frames_drawn = 0;
+    frames_coalesced = 0;
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /*** public functions ****************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
@@ -323,3 +351,66 @@ tty_init_xterm_support (gboolean is_xterm)
 }
 
 /* --------------------------------------------------------------------------------------------- */
+/**
+ * Refresh the screen not more often than mc_global.tty.max_fps times per second.
+ * Requests which come too early are coalesced: the screen is updated by one of the
+ * next requests or by tty_get_event() before waiting for input.
+ *
+ * @param force if TRUE, refresh the screen immediately
+ */
+
+void
+tty_refresh_frame (gboolean force)
+{
+    guint64 now;
+
+    now = mc_timer_elapsed (mc_global.timer);
+
+    if (!force && tty_refresh_delay () != 0)
+    {
+        frame_pending = TRUE;
+        frames_coalesced++;
+    }
+    else
+    {
+        tty_refresh ();
+        frame_last = MAX (now, 1);
+        frame_pending = FALSE;
+        frames_drawn++;
+    }
+
+    tty_frame_stat (now);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get time to wait before the next refresh of the screen. Widgets that show progress
+ * of long operation can use it to skip updates which would be never seen.
+ *
+ * @return time in microseconds, 0 if screen can be refreshed now
+ */
+
+guint64
+tty_refresh_delay (void)
+{
+    guint64 interval, elapsed;
+
+    if (mc_global.tty.max_fps <= 0 || frame_last == 0)
+        return 0;
+
+    interval = G_USEC_PER_SEC / (guint64) mc_global.tty.max_fps;
+    elapsed = mc_timer_elapsed (mc_global.timer) - frame_last;
+
+    return (elapsed >= interval) ? 0 : interval - elapsed;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/** Check whether there was a refresh request that is not done yet */
+
+gboolean
+tty_refresh_is_pending (void)
+{
+    return frame_pending;
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -133,6 +133,9 @@ extern void tty_fill_region (int y, int x, int rows, int cols, unsigned char ch)
 
 extern int tty_resize (int fd);
 extern void tty_refresh (void);
+extern void tty_refresh_frame (gboolean force);
+extern guint64 tty_refresh_delay (void);
+extern gboolean tty_refresh_is_pending (void);
 extern void tty_change_screen_size (void);
 
 extern int mc_tty_normalize_lines_char (const char *);
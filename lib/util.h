@@ -35,8 +35,21 @@
 #define MC_PIPE_ERROR_CREATE_PIPE_STREAM -4
 #define MC_PIPE_ERROR_READ -5
 
+/* I/O scheduling priority, see ioprio_set(2) */
+#define MC_IOPRIO_WHO_PROCESS 1
+#define MC_IOPRIO_VALUE(class, level) (((class) << 13) | (level))
+
 /*** enums ***************************************************************************************/
 
+/* I/O scheduling classes */
+typedef enum
+{
+    MC_IOPRIO_CLASS_NONE = 0,
+    MC_IOPRIO_CLASS_RT = 1,
+    MC_IOPRIO_CLASS_BE = 2,
+    MC_IOPRIO_CLASS_IDLE = 3
+} mc_ioprio_class_t;
+
 /* Pathname canonicalization */
 typedef enum
 {
@@ -91,17 +104,12 @@ typedef struct
 
 /*** structures declarations (and typedefs of structures)*****************************************/
 
-/* keys are set only during sorting */
 typedef struct
 {
     /* File attributes */
     size_t fnamelen;
     char *fname;
     struct stat st;
-    /* key used for comparing names */
-    char *sort_key;
-    /* key used for comparing extensions */
-    char *second_sort_key;
 
     /* Flags */
     struct
@@ -111,6 +119,10 @@ typedef struct
         unsigned int stale_link:1;      /* If this is a symlink and points to Charon's land */
         unsigned int dir_size_computed:1;       /* Size of directory was computed with dirsizes_cmd */
     } f;
+
+    /* Color of file highlighting, computed by mc_fhl_get_color() on demand */
+    unsigned int fhl_id;        /* rules the color is computed by, 0 if not computed */
+    int fhl_color;
 } file_entry_t;
 
 /*** global variables defined in .c file *********************************************************/
@@ -246,6 +258,9 @@ char *guess_message_value (void);
 char *mc_build_filename (const char *first_element, ...);
 char *mc_build_filenamev (const char *first_element, va_list args);
 
+int mc_ioprio_get (pid_t pid);
+int mc_ioprio_set (pid_t pid, int ioprio);
+
 /* *INDENT-OFF* */
 void mc_propagate_error (GError ** dest, int code, const char *format, ...) G_GNUC_PRINTF (3, 4);
 void mc_replace_error (GError ** dest, int code, const char *format, ...) G_GNUC_PRINTF (3, 4);
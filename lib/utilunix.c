@@ -53,6 +53,9 @@
 #include <sys/select.h>
 #endif
 #include <sys/wait.h>
+#ifdef __linux__
+#include <sys/syscall.h>        /* SYS_ioprio_get, SYS_ioprio_set */
+#endif
 #ifdef HAVE_SYS_IOCTL_H
 #include <sys/ioctl.h>
 #endif
@@ -1376,3 +1379,47 @@ mc_build_filename (const char *first_element, ...)
 }
 
 /* --------------------------------------------------------------------------------------------- */
+/**
+ * Get I/O scheduling priority of the process.
+ *
+ * @param pid process ID, 0 for the current process
+ *
+ * @return value built by MC_IOPRIO_VALUE() or -1 if not supported
+ */
+
+int
+mc_ioprio_get (pid_t pid)
+{
+#if defined(__linux__) && defined(SYS_ioprio_get)
+    return (int) syscall (SYS_ioprio_get, MC_IOPRIO_WHO_PROCESS, (int) pid);
+#else
+    (void) pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Set I/O scheduling priority of the process.
+ *
+ * @param pid process ID, 0 for the current process
+ * @param ioprio value built by MC_IOPRIO_VALUE()
+ *
+ * @return 0 on success, -1 on error or if not supported
+ */
+
+int
+mc_ioprio_set (pid_t pid, int ioprio)
+{
+#if defined(__linux__) && defined(SYS_ioprio_set)
+    return (int) syscall (SYS_ioprio_set, MC_IOPRIO_WHO_PROCESS, (int) pid, ioprio);
+#else
+    (void) pid;
+    (void) ioprio;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+/* --------------------------------------------------------------------------------------------- */
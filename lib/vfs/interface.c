@@ -492,14 +492,18 @@ mc_readdir (DIR * dirp)
         if (entry == NULL)
             return NULL;
 
-        g_string_set_size (vfs_str_buffer, 0);
+        mc_readdir_result->d_ino = entry->d_ino;
 #ifdef HAVE_CHARSET
-        str_vfs_convert_from (vfs_path_element->dir.converter, entry->d_name, vfs_str_buffer);
-#else
-        g_string_assign (vfs_str_buffer, entry->d_name);
+        if (vfs_path_element->dir.converter != str_cnv_not_convert)
+        {
+            /* single-byte encodings are recoded by table of converter */
+            g_string_set_size (vfs_str_buffer, 0);
+            str_vfs_convert_from (vfs_path_element->dir.converter, entry->d_name, vfs_str_buffer);
+            g_strlcpy (mc_readdir_result->d_name, vfs_str_buffer->str, MAXNAMLEN + 1);
+        }
+        else
 #endif
-        mc_readdir_result->d_ino = entry->d_ino;
-        g_strlcpy (mc_readdir_result->d_name, vfs_str_buffer->str, MAXNAMLEN + 1);
+            g_strlcpy (mc_readdir_result->d_name, entry->d_name, MAXNAMLEN + 1);
     }
     if (entry == NULL)
         errno = vfs->readdir ? vfs_ferrno (vfs) : E_NOTSUPP;
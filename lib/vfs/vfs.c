@@ -659,3 +659,47 @@ vfs_preallocate (int dest_vfs_fd, off_t src_fsize, off_t dest_fsize)
 }
 
 /* --------------------------------------------------------------------------------------------- */
+/**
+ * Drop cached pages of local file, so that they don't evict other data and next reading
+ * goes to the disk. Non-local files are not touched.
+ *
+ * @param vfs_fd mc VFS file handler
+ * @param offset start of range
+ * @param len length of range, 0 means up to the end of file
+ * @param sync if TRUE, write dirty pages first, otherwise they are kept
+ *
+ * @return 0 if success and non-zero otherwise.
+ */
+
+int
+vfs_drop_cache (int vfs_fd, off_t offset, off_t len, gboolean sync)
+{
+#ifndef HAVE_POSIX_FADVISE
+    (void) vfs_fd;
+    (void) offset;
+    (void) len;
+    (void) sync;
+    return 0;
+
+#else /* HAVE_POSIX_FADVISE */
+    int *fd;
+    struct vfs_class *vclass;
+
+    vclass = vfs_class_find_by_handle (vfs_fd);
+    if (vclass == NULL || (vclass->flags & VFSF_LOCAL) == 0)
+        return 0;
+
+    fd = (int *) vfs_class_data_find_by_handle (vfs_fd);
+    if (fd == NULL)
+        return 0;
+
+    /* dirty pages are not dropped */
+    if (sync && fsync (*fd) != 0)
+        return -1;
+
+    return posix_fadvise (*fd, offset, len, POSIX_FADV_DONTNEED);
+
+#endif /* HAVE_POSIX_FADVISE */
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -275,6 +275,7 @@ void vfs_setup_cwd (void);
 char *_vfs_get_cwd (void);
 
 int vfs_preallocate (int dest_desc, off_t src_fsize, off_t dest_fsize);
+int vfs_drop_cache (int vfs_fd, off_t offset, off_t len, gboolean sync);
 
 /**
  * Interface functions described in interface.c
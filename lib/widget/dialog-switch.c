@@ -128,6 +128,25 @@ dlg_resize_cb (void *data, void *user_data)
         d->winch_pending = TRUE;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+dialog_refresh (gboolean force)
+{
+#ifdef ENABLE_BACKGROUND
+    if (mc_global.we_are_background)
+        return;
+#endif /* ENABLE_BACKGROUND */
+    if (mc_global.tty.winch_flag == 0)
+        tty_refresh_frame (force);
+    else
+    {
+        /* if winch was caugth, we should do not only redraw screen, but
+           reposition/resize all */
+        dialog_change_screen_size ();
+    }
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /*** public functions ****************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
@@ -348,18 +367,20 @@ repaint_screen (void)
 void
 mc_refresh (void)
 {
-#ifdef ENABLE_BACKGROUND
-    if (mc_global.we_are_background)
-        return;
-#endif /* ENABLE_BACKGROUND */
-    if (mc_global.tty.winch_flag == 0)
-        tty_refresh ();
-    else
-    {
-        /* if winch was caugth, we should do not only redraw screen, but
-           reposition/resize all */
-        dialog_change_screen_size ();
-    }
+    /* status messages must be shown at once */
+    dialog_refresh (TRUE);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Refresh the screen from a loop of long operation. Refreshes which come faster than
+ * screen_max_fps are coalesced, the last state is shown before waiting for input.
+ */
+
+void
+mc_refresh_frame (void)
+{
+    dialog_refresh (FALSE);
 }
 
 /* --------------------------------------------------------------------------------------------- */
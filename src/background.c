@@ -41,16 +41,22 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>           /* gettimeofday() */
 #include <sys/wait.h>           /* waitpid() */
+#ifdef HAVE_MMAP
+#include <sys/mman.h>           /* mmap() */
+#endif
 
 #include "lib/global.h"
 
 #include "lib/unixcompat.h"
 #include "lib/tty/key.h"        /* add_select_channel(), delete_select_channel() */
+#include "lib/util.h"           /* mc_ioprio_set() */
 #include "lib/widget.h"         /* message() */
 #include "lib/event-types.h"
 
 #include "filemanager/fileopctx.h"      /* file_op_context_t */
+#include "setup.h"              /* background_jobs_per_device */
 
 #include "background.h"
 
@@ -60,6 +66,10 @@
 
 /*** file scope macro definitions ****************************************************************/
 
+#if defined(HAVE_MMAP) && !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
 /*** file scope type declarations ****************************************************************/
 
 enum ReturnType
@@ -76,6 +86,9 @@ static int parent_fd;
 /* File descriptor for messages from our parent */
 static int from_parent_fd;
 
+/* Progress of job shared with our parent */
+static background_progress_t *child_progress = NULL;
+
 struct TaskList *task_list = NULL;
 
 static int background_attention (int fd, void *closure);
@@ -83,21 +96,176 @@ static int background_attention (int fd, void *closure);
 /*** file scope functions ************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
 
+static background_progress_t *
+background_progress_new (void)
+{
+    background_progress_t *progress = NULL;
+
+#if defined(HAVE_MMAP) && defined(MAP_ANONYMOUS)
+    void *p;
+
+    p = mmap (NULL, sizeof (background_progress_t), PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p != MAP_FAILED)
+    {
+        progress = (background_progress_t *) p;
+        memset (progress, 0, sizeof (*progress));
+    }
+#endif
+
+    return progress;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+background_progress_free (background_progress_t * progress)
+{
+#if defined(HAVE_MMAP) && defined(MAP_ANONYMOUS)
+    if (progress != NULL)
+        munmap (progress, sizeof (*progress));
+#else
+    (void) progress;
+#endif
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+ * Wait until the parent allows the job to start. Called in the background process.
+ */
+
+static void
+background_wait_start (void)
+{
+    char c;
+
+    while (read (from_parent_fd, &c, 1) == -1 && errno == EINTR)
+        ;
+
+    if (child_progress != NULL)
+    {
+        struct timeval tv;
+
+        gettimeofday (&tv, NULL);
+        g_atomic_int_inc (&child_progress->seq);
+        child_progress->start = (gint64) tv.tv_sec * G_USEC_PER_SEC + tv.tv_usec;
+        g_atomic_int_inc (&child_progress->seq);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+background_task_set_ioprio (const TaskList * tl)
+{
+    int ioprio;
+
+    switch (tl->priority)
+    {
+    case Task_Priority_High:
+        ioprio = MC_IOPRIO_VALUE (MC_IOPRIO_CLASS_BE, 0);
+        break;
+    case Task_Priority_Low:
+        ioprio = MC_IOPRIO_VALUE (MC_IOPRIO_CLASS_IDLE, 0);
+        break;
+    default:
+        ioprio = MC_IOPRIO_VALUE (MC_IOPRIO_CLASS_BE, 4);
+        break;
+    }
+
+    /* not fatal: the job just runs with inherited I/O priority */
+    (void) mc_ioprio_set (tl->pid, ioprio);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static gboolean
+background_device_has_slot (dev_t dev)
+{
+    const TaskList *tl;
+    int running = 0;
+
+    if (background_jobs_per_device <= 0)
+        return TRUE;
+
+    for (tl = task_list; tl != NULL; tl = tl->next)
+        if (tl->state == Task_Running && tl->dev == dev)
+            running++;
+
+    return (running < background_jobs_per_device);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+background_task_start (TaskList * tl)
+{
+    if (tl->started)
+        kill (tl->pid, SIGCONT);
+    else
+    {
+        char c = '\0';
+
+        /* if the child is already dead, we'll know it from the control stream */
+        (void) write (tl->to_child_fd, &c, 1);
+        tl->started = TRUE;
+    }
+
+    tl->state = Task_Running;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Start queued jobs while their devices have free slots. Jobs of higher priority go first,
+ * jobs of the same priority are started in order of submission.
+ */
+
+static void
+background_schedule (void)
+{
+    while (TRUE)
+    {
+        TaskList *tl, *next = NULL;
+
+        /* task_list is in reverse order of submission */
+        for (tl = task_list; tl != NULL; tl = tl->next)
+            if (tl->state == Task_Queued && (next == NULL || tl->priority <= next->priority)
+                && background_device_has_slot (tl->dev))
+                next = tl;
+
+        if (next == NULL)
+            break;
+
+        background_task_start (next);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
 static void
-register_task_running (file_op_context_t * ctx, pid_t pid, int fd, int to_child, char *info)
+register_task_running (file_op_context_t * ctx, pid_t pid, int fd, int to_child, char *info,
+                       dev_t dev, background_progress_t * progress)
 {
     TaskList *new;
 
     new = g_new (TaskList, 1);
     new->pid = pid;
     new->info = info;
-    new->state = Task_Running;
+    new->progress = progress;
+    new->state = Task_Queued;
+    new->priority = ctx->idle_io ? Task_Priority_Low : Task_Priority_Normal;
+    new->dev = dev;
+    new->started = FALSE;
     new->next = task_list;
     new->fd = fd;
     new->to_child_fd = to_child;
     task_list = new;
 
     add_select_channel (fd, background_attention, ctx);
+
+    background_task_set_ioprio (new);
+    background_schedule ();
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -107,6 +275,7 @@ destroy_task_and_return_fd (pid_t pid)
 {
     TaskList *p = task_list;
     TaskList *prev = 0;
+    int fd;
 
     while (p)
     {
@@ -116,9 +285,13 @@ destroy_task_and_return_fd (pid_t pid)
                 prev->next = p->next;
             else
                 task_list = p->next;
+            fd = p->fd;
+            background_progress_free (p->progress);
             g_free (p->info);
             g_free (p);
-            return p->fd;
+            /* the slot of the job is free now */
+            background_schedule ();
+            return fd;
         }
         prev = p;
         p = p->next;
@@ -515,7 +688,56 @@ unregister_task_with_pid (pid_t pid)
 
 /* --------------------------------------------------------------------------------------------- */
 /**
- * Try to make the Midnight Commander a background job
+ * Stop the job. Its slot on the device is given to the next queued job.
+ */
+
+void
+background_task_stop (TaskList * task)
+{
+#ifdef SIGTSTP
+    if (task->state == Task_Running)
+        kill (task->pid, SIGSTOP);
+
+    task->state = Task_Stopped;
+    background_schedule ();
+#else
+    (void) task;
+#endif
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Resume the stopped job. It is continued when its device has a free slot.
+ */
+
+void
+background_task_resume (TaskList * task)
+{
+    if (task->state != Task_Stopped)
+        return;
+
+    task->state = Task_Queued;
+    background_schedule ();
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+void
+background_task_set_priority (TaskList * task, int priority)
+{
+    task->priority = priority;
+    background_task_set_ioprio (task);
+    background_schedule ();
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Try to make the Midnight Commander a background job. The job is queued and waits
+ * until the device it works on has a free slot.
+ *
+ * @param ctx file operation context
+ * @param info description of the job
+ * @param dev device the job works on
  *
  * Returns:
  *  1 for parent
@@ -523,10 +745,11 @@ unregister_task_with_pid (pid_t pid)
  * -1 on failure
  */
 int
-do_background (file_op_context_t * ctx, char *info)
+do_background (file_op_context_t * ctx, char *info, dev_t dev)
 {
     int comm[2];                /* control connection stream */
     int back_comm[2];           /* back connection */
+    background_progress_t *progress;
     pid_t pid;
 
     if (pipe (comm) == -1)
@@ -535,6 +758,9 @@ do_background (file_op_context_t * ctx, char *info)
     if (pipe (back_comm) == -1)
         return -1;
 
+    /* progress is passed through shared memory, so the child doesn't wait for the parent */
+    progress = background_progress_new ();
+
     pid = fork ();
     if (pid == -1)
     {
@@ -544,6 +770,7 @@ do_background (file_op_context_t * ctx, char *info)
         (void) close (comm[1]);
         (void) close (back_comm[0]);
         (void) close (back_comm[1]);
+        background_progress_free (progress);
         errno = saved_errno;
         return -1;
     }
@@ -554,6 +781,7 @@ do_background (file_op_context_t * ctx, char *info)
 
         parent_fd = comm[1];
         from_parent_fd = back_comm[0];
+        child_progress = progress;
 
         mc_global.we_are_background = TRUE;
         top_dlg = NULL;
@@ -574,16 +802,85 @@ do_background (file_op_context_t * ctx, char *info)
                 ;
         }
 
+        background_wait_start ();
+
         return 0;
     }
     else
     {
         ctx->pid = pid;
-        register_task_running (ctx, pid, comm[0], back_comm[1], info);
+        register_task_running (ctx, pid, comm[0], back_comm[1], info, dev, progress);
         return 1;
     }
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Publish progress of the job. Called in the background process, never blocks.
+ *
+ * @param count number of processed files
+ * @param bytes number of processed bytes
+ * @param name file being processed, NULL to keep previous one
+ */
+
+void
+background_progress_update (size_t count, uintmax_t bytes, const char *name)
+{
+    background_progress_t *progress = child_progress;
+
+    if (progress == NULL)
+        return;
+
+    /* the only writer: seq is odd while the block is inconsistent */
+    g_atomic_int_inc (&progress->seq);
+
+    progress->count = count;
+    progress->bytes = bytes;
+    if (name != NULL && strcmp (progress->name, name) != 0)
+        g_strlcpy (progress->name, name, sizeof (progress->name));
+
+    g_atomic_int_inc (&progress->seq);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get consistent copy of progress of the background job.
+ *
+ * @param task background job
+ * @param progress where to store the copy
+ *
+ * @return TRUE if progress is available, FALSE otherwise
+ */
+
+gboolean
+background_progress_get (const TaskList * task, background_progress_t * progress)
+{
+    int i;
+
+    if (task->progress == NULL)
+        return FALSE;
+
+    /* the child doesn't wait for us, so try a few times and give up */
+    for (i = 0; i < 100; i++)
+    {
+        gint seq;
+
+        seq = g_atomic_int_get (&task->progress->seq);
+        if ((seq & 1) != 0)
+            continue;
+
+        memcpy (progress, (const void *) task->progress, sizeof (*progress));
+
+        if (g_atomic_int_get (&task->progress->seq) == seq)
+        {
+            progress->name[sizeof (progress->name) - 1] = '\0';
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
 /* --------------------------------------------------------------------------------------------- */
 
 int
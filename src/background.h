@@ -12,16 +12,39 @@
 enum TaskState
 {
     Task_Running,
-    Task_Stopped
+    Task_Stopped,
+    Task_Queued                 /* waits for free slot on its device */
 };
 
+/* lower value is scheduled first */
+enum TaskPriority
+{
+    Task_Priority_High,
+    Task_Priority_Normal,
+    Task_Priority_Low           /* also uses idle I/O class */
+};
+
+/* progress of background job in memory shared with the parent */
+typedef struct
+{
+    volatile gint seq;          /* odd while the child updates the block */
+    size_t count;               /* number of processed files */
+    uintmax_t bytes;            /* number of processed bytes */
+    gint64 start;               /* start time of job, in microseconds */
+    char name[BUF_MEDIUM];      /* file being processed */
+} background_progress_t;
+
 typedef struct TaskList
 {
     int fd;
     int to_child_fd;
     pid_t pid;
     int state;
+    int priority;
+    dev_t dev;                  /* device the job works on */
+    gboolean started;           /* the job was allowed to start */
     char *info;
+    background_progress_t *progress;    /* NULL if shared memory is not available */
     struct TaskList *next;
 } TaskList;
 
@@ -35,13 +58,20 @@ extern struct TaskList *task_list;
 
 /*** declarations of public functions ************************************************************/
 
-int do_background (file_op_context_t * ctx, char *info);
+int do_background (file_op_context_t * ctx, char *info, dev_t dev);
 int parent_call (void *routine, file_op_context_t * ctx, int argc, ...);
 char *parent_call_string (void *routine, int argc, ...);
 
 void unregister_task_running (pid_t pid, int fd);
 void unregister_task_with_pid (pid_t pid);
 
+void background_task_stop (TaskList * task);
+void background_task_resume (TaskList * task);
+void background_task_set_priority (TaskList * task, int priority);
+
+void background_progress_update (size_t count, uintmax_t bytes, const char *name);
+gboolean background_progress_get (const TaskList * task, background_progress_t * progress);
+
 gboolean background_parent_call (const gchar * event_group_name, const gchar * event_name,
                                  gpointer init_data, gpointer data);
 
@@ -42,6 +42,10 @@
 /* Initial size of the undo stack, in bytes */
 #define START_STACK_SIZE 32
 
+/* Maximum size of the text kept for undo (and for redo), in bytes.
+   Same memory as option_max_undo stack entries */
+#define MAX_UNDO_TEXT_SIZE ((unsigned long) option_max_undo * sizeof (long))
+
 /* Some codes that may be pushed onto or returned from the undo stack */
 #define CURS_LEFT       601
 #define CURS_RIGHT      602
@@ -54,6 +58,9 @@
 #define COLUMN_OFF      609
 #define DELCHAR_BR      610
 #define BACKSPACE_BR    611
+#define UNDO_CHAR       612     /* byte to insert is kept in the undo text ring */
+#define UNDO_CHAR_AHEAD 613     /* byte to insert ahead is kept in the undo text ring */
+#define UNDO_REPLACE    614     /* set of replacements is kept in the undo text ring */
 #define MARK_1          1000
 #define MARK_2          500000000
 #define MARK_CURS       1000000000
@@ -107,6 +114,21 @@ typedef struct edit_search_options_t
     gboolean all_codepages;
 } edit_search_options_t;
 
+/* replacement of a buffer range */
+typedef struct
+{
+    off_t start;                /* start of range */
+    gsize del_len;              /* number of bytes to delete */
+    gsize ins_len;              /* number of bytes to insert */
+} edit_replace_range_t;
+
+/* set of replacements done by one action, see edit_replace_ranges() */
+typedef struct
+{
+    GArray *ranges;             /* edit_replace_range_t sorted by start, not overlapped */
+    GString *text;              /* texts to insert into all ranges one after another */
+} edit_replace_t;
+
 typedef struct edit_stack_type
 {
     long line;
@@ -184,6 +206,11 @@ void edit_push_undo_action (WEdit * edit, long c);
 void edit_push_redo_action (WEdit * edit, long c);
 void edit_push_key_press (WEdit * edit);
 void edit_insert_ahead (WEdit * edit, int c);
+edit_replace_t *edit_replace_new (void);
+void edit_replace_add (edit_replace_t * r, off_t start, gsize del_len, const char *text,
+                       gsize len);
+void edit_replace_free (edit_replace_t * r);
+void edit_replace_ranges (WEdit * edit, edit_replace_t * r);
 off_t edit_write_stream (WEdit * edit, FILE * f);
 char *edit_get_write_filter (const vfs_path_t * write_name_vpath,
                              const vfs_path_t * filename_vpath);
@@ -267,6 +294,7 @@ void edit_set_filename (WEdit * edit, const vfs_path_t * name_vpath);
 void edit_load_syntax (WEdit * edit, GPtrArray * pnames, const char *type);
 void edit_free_syntax_rules (WEdit * edit);
 int edit_get_syntax_color (WEdit * edit, off_t byte_index);
+gboolean edit_syntax_idle (WEdit * edit);
 
 void book_mark_insert (WEdit * edit, long line, int c);
 gboolean book_mark_query_color (WEdit * edit, long line, int c);
@@ -68,6 +68,7 @@
 
 #include "edit-impl.h"
 #include "editwidget.h"
+#include "editwords.h"
 #ifdef HAVE_ASPELL
 #include "spell.h"
 #endif
@@ -451,6 +452,7 @@ edit_load_file (WEdit * edit)
             edit->undo_stack_disable = 0;
         }
     }
+    edit_buffer_set_clean (&edit->buffer);
     edit->lb = LB_ASIS;
     return TRUE;
 }
@@ -517,6 +519,225 @@ edit_purge_widget (WEdit * edit)
 
 /* --------------------------------------------------------------------------------------------- */
 
+static void
+edit_undo_text_init (edit_undo_text_t * text)
+{
+    text->size = START_STACK_SIZE;
+    text->size_mask = START_STACK_SIZE - 1;
+    text->data = g_malloc (text->size);
+    text->bottom = text->pointer = 0;
+    text->replaces = g_queue_new ();
+    text->replaces_size = 0;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static unsigned long
+edit_replace_get_size (const edit_replace_t * r)
+{
+    return r->text->len + r->ranges->len * sizeof (edit_replace_range_t);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/** Store a set of replacements of an UNDO_REPLACE action and charge it to the ring budget */
+
+static void
+edit_undo_text_push_replace (edit_undo_text_t * text, edit_replace_t * r)
+{
+    g_queue_push_tail (text->replaces, r);
+    text->replaces_size += edit_replace_get_size (r);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Take a set of replacements out of the ring.
+ *
+ * @param text text ring
+ * @param oldest TRUE to take the oldest set, FALSE to take the newest one
+ * @return set of replacements or NULL if there are none
+ */
+
+static edit_replace_t *
+edit_undo_text_pop_replace (edit_undo_text_t * text, gboolean oldest)
+{
+    edit_replace_t *r;
+
+    r = (edit_replace_t *) (oldest ? g_queue_pop_head (text->replaces)
+                            : g_queue_pop_tail (text->replaces));
+    if (r != NULL)
+        text->replaces_size -= edit_replace_get_size (r);
+
+    return r;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_undo_text_clear (edit_undo_text_t * text)
+{
+    edit_replace_t *r;
+
+    text->bottom = text->pointer = 0;
+
+    while ((r = edit_undo_text_pop_replace (text, TRUE)) != NULL)
+        edit_replace_free (r);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_undo_text_free (edit_undo_text_t * text)
+{
+    edit_undo_text_clear (text);
+    g_queue_free (text->replaces);
+    g_free (text->data);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check whether one more byte can be stored in the text ring. Enlarge the ring if it is
+ * not wrapped yet and has not reached MAX_UNDO_TEXT_SIZE.
+ *
+ * @return TRUE if there is a room for one more byte, FALSE if the ring is full or bytes
+ *         of the ring together with sets of replacements reached MAX_UNDO_TEXT_SIZE
+ */
+
+static gboolean
+edit_undo_text_reserve (edit_undo_text_t * text)
+{
+    unsigned long used;
+
+    used = (text->pointer - text->bottom) & text->size_mask;
+    if (used + 1 + text->replaces_size > MAX_UNDO_TEXT_SIZE)
+        return FALSE;
+
+    if (text->pointer + 1 >= text->size && text->bottom <= text->pointer
+        && text->size < MAX_UNDO_TEXT_SIZE)
+    {
+        text->data = g_realloc (text->data, text->size * 2);
+        text->size <<= 1;
+        text->size_mask = text->size - 1;
+    }
+
+    return (((text->pointer + 1) & text->size_mask) != text->bottom);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Restore the byte referenced by an undo action.
+ *
+ * @param text text ring
+ * @param c action code
+ * @param pop TRUE to remove the byte from the ring, FALSE to leave it there
+ * @return action code with the byte (0-255 or 256-511) or the unchanged @c
+ */
+
+static long
+edit_undo_text_get (edit_undo_text_t * text, long c, gboolean pop)
+{
+    unsigned long p;
+    long byte;
+
+    if (c != UNDO_CHAR && c != UNDO_CHAR_AHEAD)
+        return c;
+
+    if (text->pointer == text->bottom)
+        return STACK_BOTTOM;
+
+    p = (text->pointer - 1) & text->size_mask;
+    byte = text->data[p];
+    if (pop)
+        text->pointer = p;
+
+    return c == UNDO_CHAR ? byte : byte + 256;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Move the bottom of an undo (or redo) stack one key press forward and release the text
+ * of removed actions.
+ */
+
+static void
+edit_undo_drop_key_press (const long *stack, unsigned long size_mask, unsigned long *bottom,
+                          unsigned long pointer, edit_undo_text_t * text)
+{
+    unsigned long n = 0, nr = 0;
+    long prev = 0;
+
+    do
+    {
+        long a = stack[*bottom];
+
+        if (a == UNDO_CHAR || a == UNDO_CHAR_AHEAD)
+            n++;
+        else if (a == UNDO_REPLACE)
+            nr++;
+        else if (a < 0 && (prev == UNDO_CHAR || prev == UNDO_CHAR_AHEAD))
+            n += -a - 1;        /* compressed repetitions of the previous entry */
+        else if (a < 0 && prev == UNDO_REPLACE)
+            nr += -a - 1;
+
+        prev = a;
+        *bottom = (*bottom + 1) & size_mask;
+    }
+    while (stack[*bottom] < KEY_PRESS && *bottom != pointer);
+
+    text->bottom = (text->bottom + n) & text->size_mask;
+
+    for (; nr != 0; nr--)
+        edit_replace_free (edit_undo_text_pop_replace (text, TRUE));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Remove the oldest key presses from an undo (or redo) stack until bytes of the text ring
+ * and sets of replacements fit MAX_UNDO_TEXT_SIZE. Called before an UNDO_REPLACE action
+ * is pushed, so the set just stored is kept even if it doesn't fit alone.
+ */
+
+static void
+edit_undo_text_trim (const long *stack, unsigned long size_mask, unsigned long *bottom,
+                     unsigned long pointer, edit_undo_text_t * text)
+{
+    while (*bottom != pointer
+           && ((text->pointer - text->bottom) & text->size_mask) + text->replaces_size >
+           MAX_UNDO_TEXT_SIZE)
+        edit_undo_drop_key_press (stack, size_mask, bottom, pointer, text);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Store a byte of an insert (0-255) or insert ahead (256-511) action in the text ring.
+ * If the ring is full, the oldest key presses are removed from the stack.
+ *
+ * @return action code to be pushed onto the stack instead of @c
+ */
+
+static long
+edit_undo_text_push (long *stack, unsigned long size_mask, unsigned long *bottom,
+                     unsigned long *pointer, edit_undo_text_t * text, long c)
+{
+    while (!edit_undo_text_reserve (text))
+    {
+        if (*bottom == *pointer)
+        {
+            /* stack is empty but text is not: should not be happened */
+            edit_undo_text_clear (text);
+            break;
+        }
+
+        edit_undo_drop_key_press (stack, size_mask, bottom, *pointer, text);
+    }
+
+    text->data[text->pointer] = (unsigned char) (c & 0xFF);
+    text->pointer = (text->pointer + 1) & text->size_mask;
+
+    return c < 256 ? UNDO_CHAR : UNDO_CHAR_AHEAD;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
 /*
    TODO: if the user undos until the stack bottom, and the stack has not wrapped,
    then the file should be as it was when he loaded up. Then set edit->modified to 0.
@@ -537,7 +758,7 @@ edit_pop_undo_action (WEdit * edit)
     {
         /*      edit->undo_stack[sp] = '@'; */
         edit->undo_stack_pointer = (edit->undo_stack_pointer - 1) & edit->undo_stack_size_mask;
-        return c;
+        return edit_undo_text_get (&edit->undo_text, c, TRUE);
     }
 
     if (sp == edit->undo_stack_bottom)
@@ -552,7 +773,7 @@ edit_pop_undo_action (WEdit * edit)
     else
         edit->undo_stack[sp]++;
 
-    return c;
+    return edit_undo_text_get (&edit->undo_text, c, TRUE);
 }
 
 static long
@@ -569,7 +790,7 @@ edit_pop_redo_action (WEdit * edit)
     if (c >= 0)
     {
         edit->redo_stack_pointer = (edit->redo_stack_pointer - 1) & edit->redo_stack_size_mask;
-        return c;
+        return edit_undo_text_get (&edit->redo_text, c, TRUE);
     }
 
     if (sp == edit->redo_stack_bottom)
@@ -581,7 +802,7 @@ edit_pop_redo_action (WEdit * edit)
     else
         edit->redo_stack[sp]++;
 
-    return c;
+    return edit_undo_text_get (&edit->redo_text, c, TRUE);
 }
 
 static long
@@ -596,13 +817,13 @@ get_prev_undo_action (WEdit * edit)
     sp = (sp - 1) & edit->undo_stack_size_mask;
     c = edit->undo_stack[sp];
     if (c >= 0)
-        return c;
+        return edit_undo_text_get (&edit->undo_text, c, FALSE);
 
     if (sp == edit->undo_stack_bottom)
         return STACK_BOTTOM;
 
     c = edit->undo_stack[(sp - 1) & edit->undo_stack_size_mask];
-    return c;
+    return edit_undo_text_get (&edit->undo_text, c, FALSE);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -1128,6 +1349,84 @@ edit_left_delete_word (WEdit * edit)
     }
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Replace buffer ranges without recording anything onto the undo and redo stacks.
+ * The cursor is placed at the start of the first range before and after the replacement,
+ * so the result can be applied in the same state of the buffer.
+ *
+ * @param edit editor object
+ * @param r set of replacements
+ *
+ * @return newly allocated set of replacements which reverts @r
+ */
+
+static edit_replace_t *
+edit_replace_apply (WEdit * edit, const edit_replace_t * r)
+{
+    edit_replace_t *reverse;
+    const char *text = r->text->str;
+    off_t delta = 0;
+    guint i;
+
+    reverse = edit_replace_new ();
+    if (r->ranges->len == 0)
+        return reverse;
+
+    edit->undo_stack_suspend = 1;
+
+    for (i = 0; i < r->ranges->len; i++)
+    {
+        const edit_replace_range_t *range = &g_array_index (r->ranges, edit_replace_range_t, i);
+        edit_replace_range_t rev;
+        gsize j;
+
+        rev.start = range->start + delta;
+        rev.del_len = range->ins_len;
+        rev.ins_len = range->del_len;
+        g_array_append_val (reverse->ranges, rev);
+
+        edit_cursor_move (edit, rev.start - edit->buffer.curs1);
+
+        for (j = 0; j < range->del_len; j++)
+            g_string_append_c (reverse->text, (char) edit_delete (edit, TRUE));
+        for (j = 0; j < range->ins_len; j++)
+            edit_insert (edit, (unsigned char) text[j]);
+
+        text += range->ins_len;
+        delta += (off_t) range->ins_len - (off_t) range->del_len;
+    }
+
+    edit_cursor_move (edit, g_array_index (r->ranges, edit_replace_range_t, 0).start
+                      - edit->buffer.curs1);
+
+    edit->undo_stack_suspend = 0;
+    edit->force |= REDRAW_PAGE;
+
+    return reverse;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Revert the last set of replacements of the undo (or redo) stack and keep its reverse
+ * for redo (or undo).
+ */
+
+static void
+edit_undo_replace (WEdit * edit, edit_undo_text_t * from, edit_undo_text_t * to)
+{
+    edit_replace_t *r;
+
+    r = edit_undo_text_pop_replace (from, FALSE);
+    if (r == NULL)
+        return;
+
+    edit_undo_text_push_replace (to, edit_replace_apply (edit, r));
+    edit_replace_free (r);
+    /* goes to the redo stack while undoing and to the undo stack while redoing */
+    edit_push_undo_action (edit, UNDO_REPLACE);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /**
    the start column position is not recorded, and hence does not
@@ -1162,6 +1461,9 @@ edit_do_undo (WEdit * edit)
         case DELCHAR_BR:
             edit_delete (edit, TRUE);
             break;
+        case UNDO_REPLACE:
+            edit_undo_replace (edit, &edit->undo_text, &edit->redo_text);
+            break;
         case COLUMN_ON:
             edit->column_highlight = 1;
             break;
@@ -1247,6 +1549,9 @@ edit_do_redo (WEdit * edit)
         case DELCHAR:
             edit_delete (edit, TRUE);
             break;
+        case UNDO_REPLACE:
+            edit_undo_replace (edit, &edit->redo_text, &edit->undo_text);
+            break;
         case COLUMN_ON:
             edit->column_highlight = 1;
             break;
@@ -2125,6 +2430,9 @@ edit_init (WEdit * edit, int y, int x, int lines, int cols, const vfs_path_t * f
     edit->redo_stack_size_mask = START_STACK_SIZE - 1;
     edit->redo_stack = g_malloc0 ((edit->redo_stack_size + 10) * sizeof (long));
 
+    edit_undo_text_init (&edit->undo_text);
+    edit_undo_text_init (&edit->redo_text);
+
 #ifdef HAVE_CHARSET
     edit->utf8 = FALSE;
     edit->converter = str_cnv_from_term;
@@ -2188,9 +2496,13 @@ edit_clean (WEdit * edit)
     book_mark_flush (edit, -1);
 
     edit_buffer_clean (&edit->buffer);
+    edit_words_free (edit->words);
+    edit->words = NULL;
 
     g_free (edit->undo_stack);
     g_free (edit->redo_stack);
+    edit_undo_text_free (&edit->undo_text);
+    edit_undo_text_free (&edit->redo_text);
     vfs_path_free (edit->filename_vpath);
     vfs_path_free (edit->dir_vpath);
     mc_search_free (edit->search);
@@ -2297,7 +2609,10 @@ edit_set_codeset (WEdit * edit)
  * d
  *
  * If the stack long int is 0-255 it represents a normal insert (from a backspace),
- * 256-512 is an insert ahead (from a delete), If it is betwen 600 and 700 it is one
+ * 256-512 is an insert ahead (from a delete). Such bytes are not stored in the stack itself:
+ * they are kept in the undo text ring and the stack holds UNDO_CHAR or UNDO_CHAR_AHEAD,
+ * which are compressed like any other action. So deleting a block costs one byte of memory
+ * per deleted byte and a couple of stack entries. If it is betwen 600 and 700 it is one
  * of the cursor functions define'd in edit-impl.h. 1000 through 700'000'000 is to
  * set edit->mark1 position. 700'000'000 through 1400'000'000 is to set edit->mark2
  * position.
@@ -2326,6 +2641,9 @@ edit_push_undo_action (WEdit * edit, long c)
     unsigned long spm1;
     long *t;
 
+    if (edit->undo_stack_suspend)
+        return;
+
     /* first enlarge the stack if necessary */
     if (sp > edit->undo_stack_size - 10)
     {                           /* say */
@@ -2351,7 +2669,25 @@ edit_push_undo_action (WEdit * edit, long c)
     }
 
     if (edit->redo_stack_reset)
+    {
         edit->redo_stack_bottom = edit->redo_stack_pointer = 0;
+        edit_undo_text_clear (&edit->redo_text);
+    }
+
+    if (c == UNDO_REPLACE)
+        edit_undo_text_trim (edit->undo_stack, edit->undo_stack_size_mask,
+                             &edit->undo_stack_bottom, edit->undo_stack_pointer,
+                             &edit->undo_text);
+
+    if (c >= 0 && c < 512)
+    {
+        c = edit_undo_text_push (edit->undo_stack, edit->undo_stack_size_mask,
+                                 &edit->undo_stack_bottom, &edit->undo_stack_pointer,
+                                 &edit->undo_text, c);
+        /* oldest key presses could be removed to get a room for text */
+        sp = edit->undo_stack_pointer;
+        spm1 = (sp - 1) & edit->undo_stack_size_mask;
+    }
 
     if (edit->undo_stack_bottom != sp
         && spm1 != edit->undo_stack_bottom
@@ -2391,18 +2727,16 @@ edit_push_undo_action (WEdit * edit, long c)
     c = (edit->undo_stack_pointer + 2) & edit->undo_stack_size_mask;
     if ((unsigned long) c == edit->undo_stack_bottom ||
         (((unsigned long) c + 1) & edit->undo_stack_size_mask) == edit->undo_stack_bottom)
-        do
-        {
-            edit->undo_stack_bottom = (edit->undo_stack_bottom + 1) & edit->undo_stack_size_mask;
-        }
-        while (edit->undo_stack[edit->undo_stack_bottom] < KEY_PRESS
-               && edit->undo_stack_bottom != edit->undo_stack_pointer);
+        edit_undo_drop_key_press (edit->undo_stack, edit->undo_stack_size_mask,
+                                  &edit->undo_stack_bottom, edit->undo_stack_pointer,
+                                  &edit->undo_text);
 
     /*If a single key produced enough pushes to wrap all the way round then we would notice that the [undo_stack_bottom] does not contain KEY_PRESS. The stack is then initialised: */
     if (edit->undo_stack_pointer != edit->undo_stack_bottom
         && edit->undo_stack[edit->undo_stack_bottom] < KEY_PRESS)
     {
         edit->undo_stack_bottom = edit->undo_stack_pointer = 0;
+        edit_undo_text_clear (&edit->undo_text);
     }
 }
 
@@ -2414,6 +2748,10 @@ edit_push_redo_action (WEdit * edit, long c)
     unsigned long sp = edit->redo_stack_pointer;
     unsigned long spm1;
     long *t;
+
+    if (edit->undo_stack_suspend)
+        return;
+
     /* first enlarge the stack if necessary */
     if (sp > edit->redo_stack_size - 10)
     {                           /* say */
@@ -2432,6 +2770,20 @@ edit_push_redo_action (WEdit * edit, long c)
     }
     spm1 = (edit->redo_stack_pointer - 1) & edit->redo_stack_size_mask;
 
+    if (c == UNDO_REPLACE)
+        edit_undo_text_trim (edit->redo_stack, edit->redo_stack_size_mask,
+                             &edit->redo_stack_bottom, edit->redo_stack_pointer,
+                             &edit->redo_text);
+
+    if (c >= 0 && c < 512)
+    {
+        c = edit_undo_text_push (edit->redo_stack, edit->redo_stack_size_mask,
+                                 &edit->redo_stack_bottom, &edit->redo_stack_pointer,
+                                 &edit->redo_text, c);
+        sp = edit->redo_stack_pointer;
+        spm1 = (sp - 1) & edit->redo_stack_size_mask;
+    }
+
     if (edit->redo_stack_bottom != sp
         && spm1 != edit->redo_stack_bottom
         && ((sp - 2) & edit->redo_stack_size_mask) != edit->redo_stack_bottom)
@@ -2470,12 +2822,9 @@ edit_push_redo_action (WEdit * edit, long c)
     c = (edit->redo_stack_pointer + 2) & edit->redo_stack_size_mask;
     if ((unsigned long) c == edit->redo_stack_bottom ||
         (((unsigned long) c + 1) & edit->redo_stack_size_mask) == edit->redo_stack_bottom)
-        do
-        {
-            edit->redo_stack_bottom = (edit->redo_stack_bottom + 1) & edit->redo_stack_size_mask;
-        }
-        while (edit->redo_stack[edit->redo_stack_bottom] < KEY_PRESS
-               && edit->redo_stack_bottom != edit->redo_stack_pointer);
+        edit_undo_drop_key_press (edit->redo_stack, edit->redo_stack_size_mask,
+                                  &edit->redo_stack_bottom, edit->redo_stack_pointer,
+                                  &edit->redo_text);
 
     /*
      * If a single key produced enough pushes to wrap all the way round then
@@ -2485,7 +2834,10 @@ edit_push_redo_action (WEdit * edit, long c)
 
     if (edit->redo_stack_pointer != edit->redo_stack_bottom
         && edit->redo_stack[edit->redo_stack_bottom] < KEY_PRESS)
+    {
         edit->redo_stack_bottom = edit->redo_stack_pointer = 0;
+        edit_undo_text_clear (&edit->redo_text);
+    }
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -2528,10 +2880,19 @@ edit_insert (WEdit * edit, int c)
     edit->mark2 += (edit->mark2 > edit->buffer.curs1) ? 1 : 0;
     edit->last_get_rule += (edit->last_get_rule > edit->buffer.curs1) ? 1 : 0;
 
+    if (edit->words != NULL)
+        edit_words_change_begin (edit->words, &edit->buffer, edit->buffer.curs1,
+                                 edit->buffer.curs1);
+
+    edit_buffer_mark_changed (&edit->buffer);
     edit_buffer_insert (&edit->buffer, c);
 
     /* update file length */
     edit->buffer.size++;
+
+    if (edit->words != NULL)
+        edit_words_change_end (edit->words, &edit->buffer, edit->buffer.curs1 - 1,
+                               edit->buffer.curs1);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -2563,9 +2924,93 @@ edit_insert_ahead (WEdit * edit, int c)
     edit->mark2 += (edit->mark2 >= edit->buffer.curs1) ? 1 : 0;
     edit->last_get_rule += (edit->last_get_rule >= edit->buffer.curs1) ? 1 : 0;
 
+    if (edit->words != NULL)
+        edit_words_change_begin (edit->words, &edit->buffer, edit->buffer.curs1,
+                                 edit->buffer.curs1);
+
+    edit_buffer_mark_changed (&edit->buffer);
     edit_buffer_insert_ahead (&edit->buffer, c);
 
     edit->buffer.size++;
+
+    if (edit->words != NULL)
+        edit_words_change_end (edit->words, &edit->buffer, edit->buffer.curs1,
+                               edit->buffer.curs1 + 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+edit_replace_t *
+edit_replace_new (void)
+{
+    edit_replace_t *r;
+
+    r = g_new (edit_replace_t, 1);
+    r->ranges = g_array_new (FALSE, FALSE, sizeof (edit_replace_range_t));
+    r->text = g_string_new ("");
+
+    return r;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Add a range to the set of replacements. Ranges must be added in ascending order
+ * and must not overlap.
+ *
+ * @param r set of replacements
+ * @param start start of range in the buffer before any replacement of the set
+ * @param del_len length of range
+ * @param text text to put instead of range
+ * @param len length of text
+ */
+
+void
+edit_replace_add (edit_replace_t * r, off_t start, gsize del_len, const char *text, gsize len)
+{
+    edit_replace_range_t range;
+
+    range.start = start;
+    range.del_len = del_len;
+    range.ins_len = len;
+    g_array_append_val (r->ranges, range);
+    g_string_append_len (r->text, text, len);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_replace_free (edit_replace_t * r)
+{
+    if (r != NULL)
+    {
+        g_array_free (r->ranges, TRUE);
+        g_string_free (r->text, TRUE);
+        g_free (r);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Do a set of replacements in one sweep of the buffer. Unlike edit_delete() and edit_insert(),
+ * replaced bytes are not recorded onto the undo stack one by one: the whole set is reverted
+ * by a single UNDO_REPLACE action.
+ *
+ * @param edit editor object
+ * @param r set of replacements, it is freed here
+ */
+
+void
+edit_replace_ranges (WEdit * edit, edit_replace_t * r)
+{
+    if (r->ranges->len != 0)
+    {
+        edit_cursor_move (edit, g_array_index (r->ranges, edit_replace_range_t, 0).start
+                          - edit->buffer.curs1);
+        edit_undo_text_push_replace (&edit->undo_text, edit_replace_apply (edit, r));
+        edit_push_undo_action (edit, UNDO_REPLACE);
+    }
+
+    edit_replace_free (r);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -2620,9 +3065,18 @@ edit_delete (WEdit * edit, gboolean byte_delete)
         if (edit->last_get_rule > edit->buffer.curs1)
             edit->last_get_rule--;
 
+        if (edit->words != NULL)
+            edit_words_change_begin (edit->words, &edit->buffer, edit->buffer.curs1,
+                                     edit->buffer.curs1 + 1);
+
         p = edit_buffer_delete (&edit->buffer);
+        edit_buffer_mark_changed (&edit->buffer);
 
         edit->buffer.size--;
+
+        if (edit->words != NULL)
+            edit_words_change_end (edit->words, &edit->buffer, edit->buffer.curs1,
+                                   edit->buffer.curs1);
         edit_push_undo_action (edit, p + 256);
     }
 
@@ -2681,9 +3135,18 @@ edit_backspace (WEdit * edit, gboolean byte_delete)
         if (edit->last_get_rule >= edit->buffer.curs1)
             edit->last_get_rule--;
 
+        if (edit->words != NULL)
+            edit_words_change_begin (edit->words, &edit->buffer, edit->buffer.curs1 - 1,
+                                     edit->buffer.curs1);
+
         p = edit_buffer_backspace (&edit->buffer);
+        edit_buffer_mark_changed (&edit->buffer);
 
         edit->buffer.size--;
+
+        if (edit->words != NULL)
+            edit_words_change_end (edit->words, &edit->buffer, edit->buffer.curs1,
+                                   edit->buffer.curs1);
         edit_push_undo_action (edit, p);
     }
     edit_modification (edit);
@@ -34,6 +34,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "lib/global.h"
 
@@ -131,6 +132,32 @@ edit_buffer_get_byte_ptr (const edit_buffer_t * buf, off_t byte_index)
     return (char *) b + (byte_index & M_EDIT_BUF_SIZE);
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Get pointer to the contiguous block of bytes started at specified index
+  *
+  * @param buf pointer to editor buffer
+  * @param byte_index byte index
+  * @param len length of the block
+  *
+  * @return NULL if byte_index is negative or larger than file size; pointer to block otherwise.
+  */
+static char *
+edit_buffer_get_block_ptr (const edit_buffer_t * buf, off_t byte_index, off_t * len)
+{
+    char *p;
+
+    p = edit_buffer_get_byte_ptr (buf, byte_index);
+    if (p == NULL)
+        *len = 0;
+    else if (byte_index >= buf->curs1)
+        *len = ((buf->curs1 + buf->curs2 - byte_index - 1) & M_EDIT_BUF_SIZE) + 1;
+    else
+        *len = min (EDIT_BUF_SIZE - (byte_index & M_EDIT_BUF_SIZE), buf->curs1 - byte_index);
+
+    return p;
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /*** public functions ****************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
@@ -151,6 +178,10 @@ edit_buffer_init (edit_buffer_t * buf, off_t size)
 
     buf->size = size;
     buf->lines = 0;
+
+    buf->clean_size = 0;
+    buf->clean_head = 0;
+    buf->clean_tail = 0;
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -808,6 +839,67 @@ edit_buffer_write_file (edit_buffer_t * buf, int fd)
     return ret;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Remember that the buffer is the same as the file contents.
+ *
+ * @param buf pointer to editor buffer
+ */
+
+void
+edit_buffer_set_clean (edit_buffer_t * buf)
+{
+    buf->clean_size = buf->size;
+    buf->clean_head = buf->size;
+    buf->clean_tail = buf->size;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Write the changed part of the buffer to the file in place.
+ * The file must contain the buffer as it was at the last edit_buffer_set_clean() call.
+ * If the size of buffer is not changed, only bytes between unchanged beginning and end
+ * are written, otherwise all bytes from the first changed one to the end of buffer.
+ *
+ * @param buf pointer to editor buffer
+ * @param fd file descriptor of the local file opened for writing
+ *
+ * @return TRUE if the file was successfully written, FALSE otherwise
+ */
+
+gboolean
+edit_buffer_write_changes (const edit_buffer_t * buf, int fd)
+{
+    off_t i, end;
+
+    i = buf->clean_head;
+    end = buf->size == buf->clean_size ? buf->size - buf->clean_tail : buf->size;
+
+    if (i < end && lseek (fd, i, SEEK_SET) != i)
+        return FALSE;
+
+    while (i < end)
+    {
+        const char *b;
+        off_t data_size;
+        ssize_t sz;
+
+        b = edit_buffer_get_block_ptr (buf, i, &data_size);
+        data_size = min (data_size, end - i);
+
+        sz = write (fd, b, data_size);
+        if (sz <= 0)
+            return FALSE;
+
+        i += sz;
+    }
+
+    if (buf->size != buf->clean_size && ftruncate (fd, buf->size) != 0)
+        return FALSE;
+
+    return (fsync (fd) == 0);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /**
  * Calculate percentage of specified character offset
@@ -20,6 +20,11 @@ typedef struct edit_buffer_struct
     off_t size;                 /* file size */
     long lines;                 /* total lines in the file */
     long curs_line;             /* line number of the cursor. */
+
+    /* changes since the buffer was loaded from or saved to the file */
+    off_t clean_size;           /* size of the file */
+    off_t clean_head;           /* number of unchanged bytes at the beginning */
+    off_t clean_tail;           /* number of unchanged bytes at the end */
 } edit_buffer_t;
 
 typedef struct edit_buffer_read_file_status_msg_struct
@@ -60,11 +65,31 @@ off_t edit_buffer_move_backward (const edit_buffer_t * buf, off_t current, long
 off_t edit_buffer_read_file (edit_buffer_t * buf, int fd, off_t size,
                              edit_buffer_read_file_status_msg_t * sm, gboolean * aborted);
 off_t edit_buffer_write_file (edit_buffer_t * buf, int fd);
+void edit_buffer_set_clean (edit_buffer_t * buf);
+gboolean edit_buffer_write_changes (const edit_buffer_t * buf, int fd);
 
 int edit_buffer_calc_percent (const edit_buffer_t * buf, off_t offset);
 
 /*** inline functions ****************************************************************************/
 
+/**
+ * Remember that the text is changed at the cursor position.
+ * Must be called before insertion of bytes and after deletion of bytes at the cursor.
+ *
+ * @param buf pointer to editor buffer
+ */
+
+static inline void
+edit_buffer_mark_changed (edit_buffer_t * buf)
+{
+    if (buf->clean_head > buf->curs1)
+        buf->clean_head = buf->curs1;
+    if (buf->clean_tail > buf->curs2)
+        buf->clean_tail = buf->curs2;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
 static inline int
 edit_buffer_get_current_byte (const edit_buffer_t * buf)
 {
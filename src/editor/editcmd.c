@@ -75,6 +75,7 @@
 #include "edit-impl.h"
 #include "editwidget.h"
 #include "editcmd_dialogs.h"
+#include "editwords.h"
 #ifdef HAVE_ASPELL
 #include "spell.h"
 #include "spell_dialogs.h"
@@ -177,6 +178,57 @@ edit_save_mode_callback (Widget * w, Widget * sender, widget_msg_t msg, int parm
     }
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Write only changed part of the file in place. It is possible if the file is the same
+ * as it was when it was loaded or saved last time.
+ *
+ * @param edit editor object
+ * @param filename_vpath file name
+ * @param sb result of mc_stat() on the file
+ * @return TRUE if the file was saved, FALSE if it must be written entirely
+ */
+
+static gboolean
+edit_save_changes (WEdit * edit, const vfs_path_t * filename_vpath, const struct stat *sb)
+{
+    char *filter;
+    int fd;
+    gboolean ret;
+
+    if (edit->lb != LB_ASIS || !vfs_file_is_local (filename_vpath))
+        return FALSE;
+
+    if (edit->stat1.st_mtime == 0 || edit->stat1.st_mtime != sb->st_mtime
+        || edit->stat1.st_dev != sb->st_dev || edit->stat1.st_ino != sb->st_ino
+        || edit->buffer.clean_size != sb->st_size)
+        return FALSE;
+
+    filter = edit_get_write_filter (filename_vpath, filename_vpath);
+    if (filter != NULL)
+    {
+        g_free (filter);
+        return FALSE;
+    }
+
+    fd = open (vfs_path_get_last_path_str (filename_vpath), O_WRONLY | O_BINARY);
+    if (fd == -1)
+        return FALSE;
+
+    ret = edit_buffer_write_changes (&edit->buffer, fd);
+    if (close (fd) != 0)
+        ret = FALSE;
+
+    /* Update the file information, especially the mtime. */
+    if (ret && mc_stat (filename_vpath, &edit->stat1) == -1)
+        ret = FALSE;
+
+    if (ret)
+        edit_buffer_set_clean (&edit->buffer);
+
+    return ret;
+}
+
 /* --------------------------------------------------------------------------------------------- */
 
 /*  If 0 (quick save) then  a) create/truncate <filename> file,
@@ -268,6 +320,13 @@ edit_save_file (WEdit * edit, const vfs_path_t * filename_vpath)
                 return -1;
             }
         }
+
+        /* write only changed part of the file if possible */
+        if (this_save_mode == EDIT_QUICK_SAVE && edit_save_changes (edit, real_filename_vpath, &sb))
+        {
+            vfs_path_free (real_filename_vpath);
+            return 1;
+        }
     }
 
     if (this_save_mode != EDIT_QUICK_SAVE)
@@ -410,6 +469,10 @@ edit_save_file (WEdit * edit, const vfs_path_t * filename_vpath)
         if (mc_rename (savename_vpath, real_filename_vpath) == -1)
             goto error_save;
 
+    /* the file contains the buffer as is */
+    if (p == NULL && edit->lb == LB_ASIS)
+        edit_buffer_set_clean (&edit->buffer);
+
     vfs_path_free (real_filename_vpath);
     vfs_path_free (savename_vpath);
     return 1;
@@ -588,7 +651,7 @@ edit_block_delete (WEdit * edit)
 
     if (edit->column_highlight && edit->mark2 < 0)
         edit_mark_cmd (edit, FALSE);
-    if ((end_mark - start_mark) > option_max_undo / 2)
+    if ((unsigned long) (end_mark - start_mark) > MAX_UNDO_TEXT_SIZE / 2)
     {
         /* Warning message with a query to continue or cancel the operation */
         if (edit_query_dialog2
@@ -906,6 +969,73 @@ editcmd_find (edit_search_status_msg_t * esm, gsize * len)
     return FALSE;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Replace the found string and all following ones with the same string. The matches are
+ * collected in one pass over the unchanged buffer and replaced in one sweep, which is undone
+ * by a single action. Used for searches which replacement doesn't depend on the match.
+ *
+ * @param esm search status
+ * @param replace replacement string
+ * @param len length of the string found at edit->search_start
+ *
+ * @return number of replacements
+ */
+
+static long
+edit_replace_all_batch (edit_search_status_msg_t * esm, const GString * replace, gsize len)
+{
+    WEdit *edit = esm->edit;
+    edit_replace_t *r;
+    off_t start, end, delta = 0;
+    gsize last_len;
+    long n = 0;
+
+    r = edit_replace_new ();
+
+    while (TRUE)
+    {
+        start = edit->search_start;
+        last_len = len;
+        edit_replace_add (r, start, len, replace->str, replace->len);
+        delta += (off_t) replace->len - (off_t) len;
+        n++;
+
+        /* so that we don't find the same string again */
+        edit->search_start = start + len + (len == 0 ? 1 : 0);
+        if (edit->search_start >= edit->buffer.size)
+            break;
+
+        esm->offset = edit->search_start;
+        /* matches found before cancel are replaced like the ones found before an error */
+        if ((n & 0xFF) == 0 && STATUS_MSG (esm)->update (STATUS_MSG (esm)) == B_CANCEL)
+            break;
+
+        if (!editcmd_find (esm, &len))
+        {
+            if (edit->search->error != MC_SEARCH_E_OK
+                && edit->search->error != MC_SEARCH_E_NOTFOUND)
+                edit_query_dialog (_("Search"), edit->search->error_str);
+            break;
+        }
+
+        edit->search_start = edit->search->normal_offset;
+        if (edit->search_start < 0 || edit->search_start >= edit->buffer.size)
+            break;
+    }
+
+    edit_replace_ranges (edit, r);
+
+    /* put the cursor after the last replacement */
+    end = start + delta + (off_t) last_len;
+    edit_cursor_move (edit, end - edit->buffer.curs1);
+    edit->found_start = end - (off_t) replace->len;
+    edit->found_len = replace->len;
+    edit->search_start = end + (last_len == 0 ? 1 : 0);
+
+    return n;
+}
+
 /* --------------------------------------------------------------------------------------------- */
 
 static char *
@@ -1170,143 +1300,37 @@ edit_find_word_start (const edit_buffer_t * buf, off_t * word_start, gsize * wor
     return TRUE;
 }
 
-/* --------------------------------------------------------------------------------------------- */
-/**
- * Get current word under cursor
- *
- * @param esm status message window
- * @param srch mc_search object
- * @param word_start start word position
- *
- * @return newly allocated string or NULL if no any words under cursor
- */
-
-static char *
-edit_collect_completions_get_current_word (edit_search_status_msg_t * esm, mc_search_t * srch,
-                                           off_t word_start)
-{
-    WEdit *edit = esm->edit;
-    gsize len = 0;
-    off_t i;
-    GString *temp;
-
-    if (!mc_search_run (srch, (void *) esm, word_start, edit->buffer.size, &len))
-        return NULL;
-
-    temp = g_string_sized_new (len);
-
-    for (i = 0; i < (off_t) len; i++)
-    {
-        int chr;
-
-        chr = edit_buffer_get_byte (&edit->buffer, word_start + i);
-        if (!isspace (chr))
-            g_string_append_c (temp, chr);
-    }
-
-    return g_string_free (temp, temp->len == 0);
-}
-
 /* --------------------------------------------------------------------------------------------- */
 /** collect the possible completions */
 
 static gsize
 edit_collect_completions (WEdit * edit, off_t word_start, gsize word_len,
-                          char *match_expr, GString ** compl, gsize * num)
+                          GString ** compl, gsize * num)
 {
-    gsize len = 0;
     gsize max_len = 0;
-    gsize i;
-    int skip;
-    GString *temp;
-    mc_search_t *srch;
-    off_t last_byte, start = -1;
-    char *current_word;
+    guint i;
+    GPtrArray *words;
     gboolean entire_file;
-    edit_search_status_msg_t esm;
-
-#ifdef HAVE_CHARSET
-    srch = mc_search_new (match_expr, -1, cp_source);
-#else
-    srch = mc_search_new (match_expr, -1, NULL);
-#endif
-    if (srch == NULL)
-        return 0;
 
     entire_file =
         mc_config_get_bool (mc_main_config, CONFIG_APP_SECTION,
                             "editor_wordcompletion_collect_entire_file", 0);
 
-    last_byte = entire_file ? edit->buffer.size : word_start;
+    /* build the word index once, then the editor keeps it up to date */
+    if (edit->words == NULL)
+        edit->words = edit_words_new (&edit->buffer);
 
-    srch->search_type = MC_SEARCH_T_REGEX;
-    srch->is_case_sensitive = TRUE;
-    srch->search_fn = edit_search_cmd_callback;
-    srch->update_fn = edit_search_update_callback;
-
-    esm.first = TRUE;
-    esm.edit = edit;
-    esm.offset = entire_file ? 0 : word_start;
-
-    status_msg_init (STATUS_MSG (&esm), _("Collect completions"), 1.0, simple_status_msg_init_cb,
-                     edit_search_status_update_cb, NULL);
-
-    current_word = edit_collect_completions_get_current_word (&esm, srch, word_start);
-
-    temp = g_string_new ("");
+    words = edit_words_complete (edit->words, &edit->buffer, word_start, word_len, entire_file);
 
     /* collect max MAX_WORD_COMPLETIONS completions */
-    while (mc_search_run (srch, (void *) &esm, start + 1, last_byte, &len))
+    for (i = 0; i < words->len && *num < MAX_WORD_COMPLETIONS; i++)
     {
-        g_string_set_size (temp, 0);
-        start = srch->normal_offset;
-
-        /* add matched completion if not yet added */
-        for (i = 0; i < len; i++)
-        {
-            skip = edit_buffer_get_byte (&edit->buffer, start + i);
-            if (isspace (skip))
-                continue;
-
-            /* skip current word */
-            if (start + (off_t) i == word_start)
-                break;
+        const char *word = (const char *) g_ptr_array_index (words, i);
+        gsize len;
+        GString *temp;
 
-            g_string_append_c (temp, skip);
-        }
-
-        if (temp->len == 0)
-            continue;
-
-        if (current_word != NULL && strcmp (current_word, temp->str) == 0)
-            continue;
-
-        skip = 0;
-
-        for (i = 0; i < *num; i++)
-        {
-            if (strncmp
-                ((char *) &compl[i]->str[word_len],
-                 (char *) &temp->str[word_len], max (len, compl[i]->len) - word_len) == 0)
-            {
-                GString *this = compl[i];
-                for (++i; i < *num; i++)
-                    compl[i - 1] = compl[i];
-                compl[*num - 1] = this;
-                skip = 1;
-                break;          /* skip it, already added */
-            }
-        }
-        if (skip != 0)
-            continue;
-
-        if (*num == MAX_WORD_COMPLETIONS)
-        {
-            g_string_free (compl[0], TRUE);
-            for (i = 1; i < *num; i++)
-                compl[i - 1] = compl[i];
-            (*num)--;
-        }
+        len = strlen (word);
+        temp = g_string_new_len (word, len);
 #ifdef HAVE_CHARSET
         {
             GString *recoded;
@@ -1318,18 +1342,14 @@ edit_collect_completions (WEdit * edit, off_t word_start, gsize word_len,
             g_string_free (recoded, TRUE);
         }
 #endif
-        compl[(*num)++] = g_string_new_len (temp->str, temp->len);
-        start += len;
+        compl[(*num)++] = temp;
 
         /* note the maximal length needed for the completion dialog */
         if (len > max_len)
             max_len = len;
     }
 
-    status_msg_deinit (STATUS_MSG (&esm));
-    mc_search_free (srch);
-    g_string_free (temp, TRUE);
-    g_free (current_word);
+    g_ptr_array_free (words, TRUE);
 
     return max_len;
 }
@@ -2630,13 +2650,14 @@ edit_replace_cmd (WEdit * edit, int again)
             i = edit->found_len = len;
 
             edit_cursor_move (edit, edit->search_start - edit->buffer.curs1);
-            edit_scroll_screen_over_cursor (edit);
 
             if (edit->replace_mode == 0)
             {
                 long l;
                 int prompt;
 
+                edit_scroll_screen_over_cursor (edit);
+
                 l = edit->curs_row - WIDGET (edit)->lines / 3;
                 if (l > 0)
                     edit_scroll_downward (edit, l);
@@ -2682,6 +2703,16 @@ edit_replace_cmd (WEdit * edit, int again)
                 break;
             }
 
+            /* replacement of literal search is the same for all matches */
+            if (edit->replace_mode == 1 && !edit_search_options.backwards
+                && (edit->search->search_type == MC_SEARCH_T_NORMAL
+                    || edit->search->search_type == MC_SEARCH_T_HEX))
+            {
+                times_replaced += edit_replace_all_batch (&esm, repl_str, len);
+                g_string_free (repl_str, TRUE);
+                break;
+            }
+
             /* delete then insert new */
             for (i = 0; i < len; i++)
                 edit_delete (edit, TRUE);
@@ -2706,7 +2737,18 @@ edit_replace_cmd (WEdit * edit, int again)
                     break;
             }
 
-            edit_scroll_screen_over_cursor (edit);
+            if (edit->replace_mode == 0)
+                edit_scroll_screen_over_cursor (edit);
+            else
+            {
+                /* replace all: the screen is updated once after the loop.
+                   Show progress and allow to cancel here, because the search engine
+                   doesn't do that if every line contains the search string */
+                esm.offset = edit->search_start;
+                if ((times_replaced & 0xFF) == 0
+                    && STATUS_MSG (&esm)->update (STATUS_MSG (&esm)) == B_CANCEL)
+                    break;
+            }
         }
         else
         {
@@ -3324,26 +3366,15 @@ edit_complete_word_cmd (WEdit * edit)
 {
     gsize i, max_len, word_len = 0, num_compl = 0;
     off_t word_start = 0;
-    GString *match_expr;
     GString *compl[MAX_WORD_COMPLETIONS];       /* completions */
 
     /* search start of word to be completed */
     if (!edit_find_word_start (&edit->buffer, &word_start, &word_len))
         return;
 
-    /* prepare match expression */
-    /* match_expr = g_strdup_printf ("\\b%.*s[a-zA-Z_0-9]+", word_len, bufpos); */
-    match_expr = g_string_new ("(^|\\s+|\\b)");
-    for (i = 0; i < word_len; i++)
-        g_string_append_c (match_expr, edit_buffer_get_byte (&edit->buffer, word_start + i));
-    g_string_append (match_expr,
-                     "[^\\s\\.=\\+\\[\\]\\(\\)\\,\\;\\:\\\"\\'\\-\\?\\/\\|\\\\\\{\\}\\*\\&\\^\\%%\\$#@\\!]+");
-
-    /* collect the possible completions              */
-    /* start search from begin to end of file */
+    /* collect the possible completions */
     max_len =
-        edit_collect_completions (edit, word_start, word_len, match_expr->str, (GString **) & compl,
-                                  &num_compl);
+        edit_collect_completions (edit, word_start, word_len, (GString **) & compl, &num_compl);
 
     if (num_compl > 0)
     {
@@ -3372,7 +3403,6 @@ edit_complete_word_cmd (WEdit * edit)
         }
     }
 
-    g_string_free (match_expr, TRUE);
     /* release memory before return */
     for (i = 0; i < num_compl; i++)
         g_string_free (compl[i], TRUE);
@@ -1023,6 +1023,11 @@ edit_render (WEdit * edit, int page, int row_start, int col_start, int row_end,
     if (page)                   /* if it was an expose event, 'page' would be set */
         edit->force |= REDRAW_PAGE | REDRAW_IN_BOUNDS;
 
+    /* whole page will be redrawn: forget text that was deferred for highlighting,
+       edit_get_syntax_color() will defer it again if it is still visible */
+    if ((edit->force & REDRAW_PAGE) != 0)
+        edit->syntax_deferred = 0;
+
     render_edit_text (edit, row_start, col_start, row_end, col_end);
 
     /*
@@ -1160,6 +1160,7 @@ edit_callback (Widget * w, Widget * sender, widget_msg_t msg, int parm, void *da
         }
 
     case MSG_IDLE:
+        edit_syntax_idle (e);
         edit_update_screen (e);
         return MSG_HANDLED;
 
@@ -1313,6 +1314,10 @@ edit_update_screen (WEdit * e)
         edit_render_keypress (e);
     }
 
+    /* highlight the rest of text when there are no more events */
+    if (e->syntax_deferred != 0)
+        widget_want_idle (WIDGET (h), TRUE);
+
     widget_redraw (WIDGET (find_buttonbar (h)));
 }
 
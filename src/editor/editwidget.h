@@ -48,6 +48,18 @@ struct edit_syntax_rule_t
     unsigned char border;
 };
 
+/* ring of bytes which were deleted and must be restored by undo or redo */
+typedef struct
+{
+    unsigned char *data;
+    unsigned long size;
+    unsigned long size_mask;
+    unsigned long bottom;
+    unsigned long pointer;
+    GQueue *replaces;           /* edit_replace_t of UNDO_REPLACE actions, oldest first */
+    unsigned long replaces_size;        /* bytes held by replaces, charged to the ring budget */
+} edit_undo_text_t;
+
 /*
  * State of WEdit window
  * MCEDIT_DRAG_NORMAL - window is in normal mode
@@ -140,6 +152,8 @@ struct WEdit
     unsigned long undo_stack_size_mask;
     unsigned long undo_stack_bottom;
     unsigned int undo_stack_disable:1;  /* If not 0, don't save events in the undo stack */
+    unsigned int undo_stack_suspend:1;  /* If not 0, don't save events in any stack */
+    edit_undo_text_t undo_text;
 
     unsigned long redo_stack_pointer;
     long *redo_stack;
@@ -147,6 +161,7 @@ struct WEdit
     unsigned long redo_stack_size_mask;
     unsigned long redo_stack_bottom;
     unsigned int redo_stack_reset:1;    /* If 1, need clear redo stack */
+    edit_undo_text_t redo_text;
 
     struct stat stat1;          /* Result of mc_fstat() on the file */
     unsigned int skip_detach_prompt:1;  /* Do not prompt whether to detach a file anymore */
@@ -155,11 +170,15 @@ struct WEdit
     GSList *syntax_marker;
     GPtrArray *rules;
     off_t last_get_rule;
+    off_t syntax_deferred;      /* farthest byte shown w/o highlighting, 0 if none */
     edit_syntax_rule_t rule;
     char *syntax_type;          /* description of syntax highlighting type being used */
     GTree *defines;             /* List of defines */
     gboolean is_case_insensitive;       /* selects language case sensitivity */
 
+    /* word completion */
+    struct edit_words_struct *words;    /* word index, NULL until first completion */
+
     /* line break */
     LineBreaks lb;
     gboolean extmod;
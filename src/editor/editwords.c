@@ -0,0 +1,416 @@
+/*
+   Editor word index for completion.
+
+   Copyright (C) 2015
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file
+ *  \brief Source: editor word index for completion.
+ *
+ * The index counts occurrences of every word of the buffer. A word is a maximal run of bytes
+ * that are not break characters. The index is built once and then kept up to date by the
+ * editor on every insertion and deletion of a byte, so that word completion doesn't need
+ * to scan the buffer.
+ *
+ * A second table counts the words that end before some position. It is used to complete
+ * the words found before the cursor only and is moved to the required position lazily,
+ * so that cursor movement costs nothing. A change of the buffer before that position shifts it
+ * and updates the words touched by the change only.
+ *
+ * Both tables keep their words sorted too, so completion looks up the range of words which
+ * begin with the prefix instead of walking the whole table.
+ */
+
+#include <config.h>
+
+#include <string.h>
+
+#include "lib/global.h"
+
+#include "edit-impl.h"
+#include "editwords.h"
+
+/*** global variables ****************************************************************************/
+
+/*** file scope macro definitions ****************************************************************/
+
+/* longer words are not indexed */
+#define EDIT_WORDS_MAX_LEN 128
+
+/*** file scope type declarations ****************************************************************/
+
+typedef struct
+{
+    guint count;                /* number of occurrences */
+    GSequenceIter *iter;        /* position of word in the sorted sequence */
+} edit_words_entry_t;
+
+typedef struct
+{
+    GHashTable *counts;         /* word -> edit_words_entry_t */
+    GSequence *sorted;          /* words owned by counts, in strcmp() order */
+} edit_words_table_t;
+
+struct edit_words_struct
+{
+    edit_words_table_t all;     /* words of the buffer */
+    edit_words_table_t before;  /* words ended before before_pos */
+    off_t before_pos;
+    gboolean before_shift;      /* change in progress is before before_pos */
+    off_t change_len;           /* length of bytes to be changed */
+    GString *word;              /* scratch buffer */
+};
+
+/*** file scope variables ************************************************************************/
+
+/*** file scope functions ************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+static inline gboolean
+edit_words_is_break (int c)
+{
+    return (c == '@' || is_break_char ((char) c));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static int
+edit_words_compare (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    (void) user_data;
+
+    return strcmp ((const char *) a, (const char *) b);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_words_table_init (edit_words_table_t * table)
+{
+    table->counts = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+    table->sorted = g_sequence_new (NULL);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_words_table_done (edit_words_table_t * table)
+{
+    /* words are owned by hash table */
+    g_sequence_free (table->sorted);
+    g_hash_table_destroy (table->counts);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_words_add (edit_words_table_t * table, const char *word, int delta)
+{
+    edit_words_entry_t *entry;
+
+    entry = (edit_words_entry_t *) g_hash_table_lookup (table->counts, word);
+
+    if (entry != NULL)
+    {
+        entry->count += delta;
+        if (entry->count == 0)
+        {
+            g_sequence_remove (entry->iter);
+            g_hash_table_remove (table->counts, word);
+        }
+    }
+    else if (delta > 0)
+    {
+        char *key;
+
+        key = g_strdup (word);
+        entry = g_new (edit_words_entry_t, 1);
+        entry->count = (guint) delta;
+        entry->iter = g_sequence_insert_sorted (table->sorted, key, edit_words_compare, NULL);
+        g_hash_table_insert (table->counts, key, entry);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Add or remove words of the buffer region to/from the table.
+ *
+ * @param words word index
+ * @param table table to update
+ * @param buf editor buffer
+ * @param start start of region
+ * @param end end of region
+ * @param extend if TRUE, take all words that touch the region, including those ended by the end
+ *               of the buffer; otherwise take the words whose ending break character lies
+ *               in the region
+ * @param delta number of occurrences to add to each word
+ */
+
+static void
+edit_words_scan (edit_words_t * words, edit_words_table_t * table, const edit_buffer_t * buf,
+                 off_t start, off_t end, gboolean extend, int delta)
+{
+    GString *word = words->word;
+    gsize len = 0;
+    off_t p;
+
+    /* rewind to the beginning of the word which contains start.
+       If the word is too long, stop inside it: it's not indexed anyway */
+    for (p = start; p > 0 && start - p <= EDIT_WORDS_MAX_LEN; p--)
+        if (edit_words_is_break (edit_buffer_get_byte (buf, p - 1)))
+            break;
+
+    g_string_set_size (word, 0);
+
+    for (; p < buf->size; p++)
+    {
+        int c;
+
+        if (p >= end && (!extend || len > EDIT_WORDS_MAX_LEN))
+            break;
+
+        c = edit_buffer_get_byte (buf, p);
+
+        if (!edit_words_is_break (c))
+        {
+            if (len++ < EDIT_WORDS_MAX_LEN)
+                g_string_append_c (word, (char) c);
+        }
+        else
+        {
+            if (len != 0 && len <= EDIT_WORDS_MAX_LEN)
+                edit_words_add (table, word->str, delta);
+
+            len = 0;
+            g_string_set_size (word, 0);
+
+            if (p >= end)
+                break;
+        }
+    }
+
+    /* last word of the buffer */
+    if (extend && p >= buf->size && len != 0 && len <= EDIT_WORDS_MAX_LEN)
+        edit_words_add (table, word->str, delta);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/** Move the bound of 'before' table to the new position. */
+
+static void
+edit_words_sync (edit_words_t * words, const edit_buffer_t * buf, off_t pos)
+{
+    if (pos > words->before_pos)
+        edit_words_scan (words, &words->before, buf, words->before_pos, pos, FALSE, 1);
+    else if (pos < words->before_pos)
+        edit_words_scan (words, &words->before, buf, pos, words->before_pos, FALSE, -1);
+
+    words->before_pos = pos;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/** Find the first break character at or after the position, or the end of the buffer. */
+
+static off_t
+edit_words_next_break (const edit_buffer_t * buf, off_t pos)
+{
+    for (; pos < buf->size; pos++)
+        if (edit_words_is_break (edit_buffer_get_byte (buf, pos)))
+            break;
+
+    return pos;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/*** public functions ****************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Build the word index of the buffer.
+ *
+ * @param buf editor buffer
+ *
+ * @return newly allocated word index
+ */
+
+edit_words_t *
+edit_words_new (const edit_buffer_t * buf)
+{
+    edit_words_t *words;
+
+    words = g_new (edit_words_t, 1);
+    edit_words_table_init (&words->all);
+    edit_words_table_init (&words->before);
+    words->before_pos = 0;
+    words->before_shift = FALSE;
+    words->change_len = 0;
+    words->word = g_string_sized_new (EDIT_WORDS_MAX_LEN);
+
+    edit_words_scan (words, &words->all, buf, 0, buf->size, TRUE, 1);
+
+    return words;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_words_free (edit_words_t * words)
+{
+    if (words != NULL)
+    {
+        edit_words_table_done (&words->all);
+        edit_words_table_done (&words->before);
+        g_string_free (words->word, TRUE);
+        g_free (words);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Forget the words touched by the change of buffer. Must be called before the change.
+ *
+ * @param words word index
+ * @param buf editor buffer
+ * @param start start of bytes to be changed
+ * @param end end of bytes to be changed (equal to start for insertion)
+ */
+
+void
+edit_words_change_begin (edit_words_t * words, const edit_buffer_t * buf, off_t start, off_t end)
+{
+    words->before_shift = FALSE;
+
+    if (words->before_pos > start)
+    {
+        off_t last;
+
+        /* break character which ends the last word touched by the change */
+        last = edit_words_next_break (buf, end);
+
+        if (words->before_pos > last)
+        {
+            /* forget the touched words only, the bound is shifted after the change */
+            edit_words_scan (words, &words->before, buf, start, last + 1, FALSE, -1);
+            words->before_shift = TRUE;
+            words->change_len = end - start;
+        }
+        else
+        {
+            /* bytes before start are not changed */
+            edit_words_sync (words, buf, start);
+        }
+    }
+
+    edit_words_scan (words, &words->all, buf, start, end, TRUE, -1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Index the words touched by the change of buffer. Must be called after the change.
+ *
+ * @param words word index
+ * @param buf editor buffer
+ * @param start start of changed bytes
+ * @param end end of changed bytes (equal to start for deletion)
+ */
+
+void
+edit_words_change_end (edit_words_t * words, const edit_buffer_t * buf, off_t start, off_t end)
+{
+    if (words->before_shift)
+    {
+        edit_words_scan (words, &words->before, buf, start,
+                         edit_words_next_break (buf, end) + 1, FALSE, 1);
+        words->before_pos += (end - start) - words->change_len;
+        words->before_shift = FALSE;
+    }
+
+    edit_words_scan (words, &words->all, buf, start, end, TRUE, 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Find completions of the word.
+ *
+ * @param words word index
+ * @param buf editor buffer
+ * @param word_start start of word to be completed
+ * @param word_len length of word prefix to be completed
+ * @param entire_file if TRUE, use words of entire buffer, otherwise words before word_start only
+ *
+ * @return sorted array of words owned by index. Must be freed before next change of buffer
+ */
+
+GPtrArray *
+edit_words_complete (edit_words_t * words, const edit_buffer_t * buf, off_t word_start,
+                     gsize word_len, gboolean entire_file)
+{
+    GPtrArray *ret;
+    edit_words_table_t *table;
+    GSequenceIter *iter;
+    GString *current;
+    char *prefix;
+    off_t i;
+
+    ret = g_ptr_array_new ();
+
+    if (word_len == 0 || word_len > EDIT_WORDS_MAX_LEN)
+        return ret;
+
+    /* word under cursor, it begins with the prefix to be completed */
+    current = g_string_sized_new (EDIT_WORDS_MAX_LEN);
+    for (i = word_start; i < buf->size && i - word_start <= EDIT_WORDS_MAX_LEN; i++)
+    {
+        int c;
+
+        c = edit_buffer_get_byte (buf, i);
+        if (i - word_start >= (off_t) word_len && edit_words_is_break (c))
+            break;
+        g_string_append_c (current, (char) c);
+    }
+
+    if (entire_file)
+        table = &words->all;
+    else
+    {
+        edit_words_sync (words, buf, word_start);
+        table = &words->before;
+    }
+
+    /* words which begin with the prefix follow the prefix itself in the sorted sequence */
+    prefix = g_strndup (current->str, word_len);
+    iter = g_sequence_search (table->sorted, prefix, edit_words_compare, NULL);
+
+    for (; !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter))
+    {
+        char *w;
+
+        w = (char *) g_sequence_get (iter);
+        if (strncmp (w, prefix, word_len) != 0)
+            break;
+        if (w[word_len] != '\0' && strcmp (w, current->str) != 0)
+            g_ptr_array_add (ret, w);
+    }
+
+    g_free (prefix);
+    g_string_free (current, TRUE);
+
+    return ret;
+}
+
+/* --------------------------------------------------------------------------------------------- */
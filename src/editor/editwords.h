@@ -0,0 +1,35 @@
+/** \file
+ *  \brief Header: word index for completion in WEdit
+ */
+
+#ifndef MC__EDIT_WORDS_H
+#define MC__EDIT_WORDS_H
+
+#include "editbuffer.h"
+
+/*** typedefs(not structures) and defined constants **********************************************/
+
+/*** enums ***************************************************************************************/
+
+/*** structures declarations (and typedefs of structures)*****************************************/
+
+typedef struct edit_words_struct edit_words_t;
+
+/*** global variables defined in .c file *********************************************************/
+
+/*** declarations of public functions ************************************************************/
+
+edit_words_t *edit_words_new (const edit_buffer_t * buf);
+void edit_words_free (edit_words_t * words);
+
+void edit_words_change_begin (edit_words_t * words, const edit_buffer_t * buf, off_t start,
+                              off_t end);
+void edit_words_change_end (edit_words_t * words, const edit_buffer_t * buf, off_t start,
+                            off_t end);
+
+GPtrArray *edit_words_complete (edit_words_t * words, const edit_buffer_t * buf, off_t word_start,
+                                gsize word_len, gboolean entire_file);
+
+/*** inline functions ****************************************************************************/
+
+#endif /* MC__EDIT_WORDS_H */
@@ -73,6 +73,11 @@ int option_auto_syntax = 1;
 /* bytes */
 #define SYNTAX_MARKER_DENSITY 512
 
+/* bytes: farthest distance from the last calculated rule which is highlighted synchronously */
+#define SYNTAX_DEFER_THRESHOLD (256 * 1024)
+/* bytes: amount of text scanned per idle cycle to catch up deferred highlighting */
+#define SYNTAX_IDLE_CHUNK (64 * 1024)
+
 #define TRANSIENT_WORD_TIME_OUT 60
 
 #define UNKNOWN_FORMAT "unknown"
@@ -1421,6 +1426,14 @@ edit_get_syntax_color (WEdit * edit, off_t byte_index)
 
     if (edit->rules != NULL && byte_index < edit->buffer.size && option_syntax_highlighting)
     {
+        if (byte_index > edit->last_get_rule + SYNTAX_DEFER_THRESHOLD)
+        {
+            /* don't block the screen update: show the default color now
+               and let edit_syntax_idle() calculate rules in background */
+            edit->syntax_deferred = max (edit->syntax_deferred, byte_index);
+            return EDITOR_NORMAL_COLOR;
+        }
+
         edit_get_rule (edit, byte_index);
         return translate_rule_to_color (edit, &edit->rule);
     }
@@ -1428,6 +1441,46 @@ edit_get_syntax_color (WEdit * edit, off_t byte_index)
     return EDITOR_NORMAL_COLOR;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Continue deferred syntax highlighting. Scans at most SYNTAX_IDLE_CHUNK bytes of text
+ * and requests a page redraw when the rules for all deferred text are calculated.
+ *
+ * @param edit editor object
+ * @return TRUE if there is more text to highlight, FALSE otherwise
+ */
+
+gboolean
+edit_syntax_idle (WEdit * edit)
+{
+    off_t target;
+
+    if (edit->syntax_deferred == 0)
+        return FALSE;
+
+    if (edit->rules == NULL || !option_syntax_highlighting)
+    {
+        edit->syntax_deferred = 0;
+        return FALSE;
+    }
+
+    target = min (edit->syntax_deferred, edit->buffer.size - 1);
+
+    if (target > edit->last_get_rule + SYNTAX_IDLE_CHUNK)
+    {
+        edit_get_rule (edit, edit->last_get_rule + SYNTAX_IDLE_CHUNK);
+        return TRUE;
+    }
+
+    if (target > edit->last_get_rule)
+        edit_get_rule (edit, target);
+
+    edit->syntax_deferred = 0;
+    edit->force |= REDRAW_PAGE;
+
+    return FALSE;
+}
+
 /* --------------------------------------------------------------------------------------------- */
 
 void
@@ -1450,6 +1503,7 @@ edit_free_syntax_rules (WEdit * edit)
     edit->rules = NULL;
     g_slist_free_full (edit->syntax_marker, g_free);
     edit->syntax_marker = NULL;
+    edit->syntax_deferred = 0;
     tty_color_free_all_tmp ();
 }
 
@@ -38,6 +38,11 @@
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>           /* gettimeofday() */
+#if defined(ENABLE_BACKGROUND) && defined(HAVE_SYS_TIMERFD_H)
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
 
 #include "lib/global.h"
 
@@ -87,6 +92,7 @@
 #define B_STOP   (B_USER+1)
 #define B_RESUME (B_USER+2)
 #define B_KILL   (B_USER+3)
+#define B_PRIORITY (B_USER+4)
 #endif /* ENABLE_BACKGROUND */
 
 /*** file scope type declarations ****************************************************************/
@@ -450,23 +456,65 @@ confvfs_callback (Widget * w, Widget * sender, widget_msg_t msg, int parm, void
 /* --------------------------------------------------------------------------------------------- */
 
 #ifdef ENABLE_BACKGROUND
+/**
+ * Get average throughput of the job.
+ *
+ * @param tl background job
+ * @param buffer buffer for the throughput
+ * @param len size of buffer
+ */
+
+static void
+jobs_throughput (const TaskList * tl, char *buffer, size_t len)
+{
+    background_progress_t progress;
+    struct timeval tv;
+    gint64 elapsed;
+    char size[BUF_TINY];
+
+    if (!tl->started || !background_progress_get (tl, &progress) || progress.start == 0)
+    {
+        g_strlcpy (buffer, "", len);
+        return;
+    }
+
+    gettimeofday (&tv, NULL);
+    elapsed = (gint64) tv.tv_sec * G_USEC_PER_SEC + tv.tv_usec - progress.start;
+    if (elapsed < G_USEC_PER_SEC)
+        elapsed = G_USEC_PER_SEC;
+
+    size_trunc_len (size, 6, (uintmax_t) (progress.bytes * G_USEC_PER_SEC / elapsed), 0,
+                    panels_options.kilobyte_si);
+    g_snprintf (buffer, len, "%s/s", size);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
 static void
 jobs_fill_listbox (WListbox * list)
 {
-    static const char *state_str[2] = { "", "" };
+    static const char *state_str[3] = { "", "", "" };
+    static const char *priority_str[3] = { "", "", "" };
     TaskList *tl;
 
-    if (state_str[0] == '\0')
+    if (state_str[0][0] == '\0')
     {
-        state_str[0] = _("Running");
-        state_str[1] = _("Stopped");
+        state_str[Task_Running] = _("Running");
+        state_str[Task_Stopped] = _("Stopped");
+        state_str[Task_Queued] = _("Queued");
+        priority_str[Task_Priority_High] = _("High");
+        priority_str[Task_Priority_Normal] = _("Normal");
+        priority_str[Task_Priority_Low] = _("Low");
     }
 
     for (tl = task_list; tl != NULL; tl = tl->next)
     {
+        char rate[BUF_TINY];
         char *s;
 
-        s = g_strconcat (state_str[tl->state], " ", tl->info, (char *) NULL);
+        jobs_throughput (tl, rate, sizeof (rate));
+        s = g_strdup_printf ("%-8s %-6s %9s %s", state_str[tl->state], priority_str[tl->priority],
+                             rate, tl->info);
         listbox_add_item (list, LISTBOX_APPEND_AT_END, 0, s, (void *) tl, FALSE);
         g_free (s);
     }
@@ -474,6 +522,39 @@ jobs_fill_listbox (WListbox * list)
 
 /* --------------------------------------------------------------------------------------------- */
 
+#ifdef HAVE_SYS_TIMERFD_H
+/**
+ * Refresh the list of jobs every second to show current state and throughput of jobs.
+ */
+
+static int
+jobs_timer_callback (int fd, void *info)
+{
+    WDialog *h = DIALOG (info);
+    guint64 expirations;
+    int pos;
+
+    if (read (fd, &expirations, sizeof (expirations)) <= 0)
+        return 0;
+
+    /* don't draw over other dialog */
+    if (top_dlg == NULL || top_dlg->data != h)
+        return 0;
+
+    pos = bg_list->pos;
+    listbox_remove_list (bg_list);
+    jobs_fill_listbox (bg_list);
+    listbox_select_entry (bg_list, pos);
+
+    dlg_redraw (h);
+    mc_refresh ();
+
+    return 0;
+}
+#endif /* HAVE_SYS_TIMERFD_H */
+
+/* --------------------------------------------------------------------------------------------- */
+
 static int
 task_cb (WButton * button, int action)
 {
@@ -488,26 +569,24 @@ task_cb (WButton * button, int action)
     /* Get this instance information */
     listbox_get_current (bg_list, NULL, (void **) &tl);
 
-#ifdef SIGTSTP
+    /* the scheduler sends SIGSTOP and SIGCONT itself */
     if (action == B_STOP)
-    {
-        sig = SIGSTOP;
-        tl->state = Task_Stopped;
-    }
+        background_task_stop (tl);
     else if (action == B_RESUME)
-    {
-        sig = SIGCONT;
-        tl->state = Task_Running;
-    }
-    else
-#endif
-    if (action == B_KILL)
+        background_task_resume (tl);
+    else if (action == B_PRIORITY)
+        background_task_set_priority (tl, (tl->priority + 1) % (Task_Priority_Low + 1));
+    else if (action == B_KILL)
         sig = SIGKILL;
 
     if (sig == SIGKILL)
+    {
+        pid_t pid = tl->pid;
+
         unregister_task_running (tl->pid, tl->fd);
+        kill (pid, sig);
+    }
 
-    kill (tl->pid, sig);
     listbox_remove_list (bg_list);
     jobs_fill_listbox (bg_list);
 
@@ -1270,6 +1349,7 @@ jobs_cmd (void)
         { N_("&Stop"), NORMAL_BUTTON, B_STOP, 0, task_cb },
         { N_("&Resume"), NORMAL_BUTTON, B_RESUME, 0, task_cb },
         { N_("&Kill"), NORMAL_BUTTON, B_KILL, 0, task_cb },
+        { N_("&Priority"), NORMAL_BUTTON, B_PRIORITY, 0, task_cb },
         { N_("&OK"), DEFPUSH_BUTTON, B_CANCEL, 0, NULL }
         /* *INDENT-ON* */
     };
@@ -1278,9 +1358,12 @@ jobs_cmd (void)
     const size_t n_but = G_N_ELEMENTS (job_but);
 
     WDialog *jobs_dlg;
-    int cols = 60;
+    int cols = 70;
     int lines = 15;
     int x = 0;
+#ifdef HAVE_SYS_TIMERFD_H
+    int timer_fd;
+#endif
 
     for (i = 0; i < n_but; i++)
     {
@@ -1315,7 +1398,30 @@ jobs_cmd (void)
         x += job_but[i].len + 1;
     }
 
+#ifdef HAVE_SYS_TIMERFD_H
+    timer_fd = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd != -1)
+    {
+        struct itimerspec its;
+
+        its.it_interval.tv_sec = 1;
+        its.it_interval.tv_nsec = 0;
+        its.it_value = its.it_interval;
+        timerfd_settime (timer_fd, 0, &its, NULL);
+        add_select_channel (timer_fd, jobs_timer_callback, jobs_dlg);
+    }
+#endif
+
     (void) dlg_run (jobs_dlg);
+
+#ifdef HAVE_SYS_TIMERFD_H
+    if (timer_fd != -1)
+    {
+        delete_select_channel (timer_fd);
+        close (timer_fd);
+    }
+#endif
+
     dlg_destroy (jobs_dlg);
 }
 #endif /* ENABLE_BACKGROUND */
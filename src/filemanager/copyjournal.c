@@ -0,0 +1,305 @@
+/*
+   Checkpoint journal of file copying.
+
+   Copyright (C) 2015
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file copyjournal.c
+ *  \brief Source: checkpoint journal of file copying
+ *
+ * While a large file is copied, checksums of its completed blocks are appended to
+ * the journal in the cache directory. The journal is removed when the copy is finished.
+ * If the copy is interrupted, the journal is left, and the next copy of the same unchanged
+ * source to the same target compares the blocks of the target with the journal.
+ * The copy is resumed after the last block that matches.
+ *
+ * The journal is written without syncing the target file: blocks lost by a crash
+ * simply don't match on the next run.
+ */
+
+#include <config.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lib/global.h"
+#include "lib/mcconfig.h"
+#include "lib/fileloc.h"
+#include "lib/strescape.h"
+
+#include "copyjournal.h"
+
+/*** global variables ****************************************************************************/
+
+/*** file scope macro definitions ****************************************************************/
+
+#define COPY_JOURNAL_SIGNATURE "MC copy journal 1"
+
+/*** file scope type declarations ****************************************************************/
+
+struct copy_journal_struct
+{
+    char *name;                 /* file name of journal */
+    char *header;               /* everything before the checksums of blocks */
+    GPtrArray *blocks;          /* checksums of completed blocks */
+    FILE *f;                    /* journal opened for appending, NULL if not started */
+    GChecksum *sum;             /* checksum of current block */
+    off_t fill;                 /* number of bytes in current block */
+};
+
+/*** file scope variables ************************************************************************/
+
+/*** file scope functions ************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+static char *
+copy_journal_make_header (const char *src_path, const char *dst_path, const struct stat *src_st)
+{
+    char *src, *dst, *header;
+
+    src = strutils_escape (src_path, -1, "\n\\", FALSE);
+    dst = strutils_escape (dst_path, -1, "\n\\", FALSE);
+
+    header = g_strdup_printf ("%s\n%jd %jd %jd\n%s\n%s\n", COPY_JOURNAL_SIGNATURE,
+                              (intmax_t) COPY_JOURNAL_BLOCK_SIZE, (intmax_t) src_st->st_size,
+                              (intmax_t) src_st->st_mtime, src, dst);
+
+    g_free (src);
+    g_free (dst);
+
+    return header;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Load checksums of blocks if the journal is written for the same copy.
+ */
+
+static void
+copy_journal_load (copy_journal_t * journal)
+{
+    char *contents;
+    gsize len, header_len;
+    char **lines;
+    int i;
+
+    if (!g_file_get_contents (journal->name, &contents, &len, NULL))
+        return;
+
+    header_len = strlen (journal->header);
+
+    if (len >= header_len && strncmp (contents, journal->header, header_len) == 0)
+    {
+        lines = g_strsplit (contents + header_len, "\n", -1);
+
+        /* the last line can be written partially */
+        for (i = 0; lines[i] != NULL && lines[i + 1] != NULL; i++)
+        {
+            if (strlen (lines[i]) != 32 || strspn (lines[i], "0123456789abcdef") != 32)
+                break;
+
+            g_ptr_array_add (journal->blocks, g_strdup (lines[i]));
+        }
+
+        g_strfreev (lines);
+    }
+
+    g_free (contents);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/*** public functions ****************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Create journal of file copying and load checksums left by interrupted copy of the same file.
+ *
+ * @param src_path source file name
+ * @param dst_path target file name
+ * @param src_st status of source file
+ *
+ * @return newly allocated journal
+ */
+
+copy_journal_t *
+copy_journal_new (const char *src_path, const char *dst_path, const struct stat *src_st)
+{
+    copy_journal_t *journal;
+    char *id, *base;
+
+    journal = g_new0 (copy_journal_t, 1);
+
+    id = g_compute_checksum_for_string (G_CHECKSUM_MD5, dst_path, -1);
+    base = g_strconcat (MC_COPY_JOURNAL_FILE, id, (char *) NULL);
+    journal->name = g_build_filename (mc_config_get_cache_path (), base, (char *) NULL);
+    g_free (base);
+    g_free (id);
+
+    journal->header = copy_journal_make_header (src_path, dst_path, src_st);
+    journal->blocks = g_ptr_array_new_with_free_func (g_free);
+
+    copy_journal_load (journal);
+
+    return journal;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Free journal.
+ *
+ * @param journal journal
+ * @param remove if TRUE, the journal file is removed: the copy is finished or abandoned
+ */
+
+void
+copy_journal_free (copy_journal_t * journal, gboolean remove)
+{
+    if (journal == NULL)
+        return;
+
+    if (journal->f != NULL)
+        fclose (journal->f);
+
+    if (remove)
+        unlink (journal->name);
+
+    if (journal->sum != NULL)
+        g_checksum_free (journal->sum);
+    g_ptr_array_free (journal->blocks, TRUE);
+    g_free (journal->header);
+    g_free (journal->name);
+    g_free (journal);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get number of blocks which checksums are known.
+ */
+
+guint
+copy_journal_get_blocks (const copy_journal_t * journal)
+{
+    return journal->blocks->len;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get checksum of block.
+ *
+ * @param journal journal
+ * @param block index of block
+ *
+ * @return checksum as hex string
+ */
+
+const char *
+copy_journal_get_block (const copy_journal_t * journal, guint block)
+{
+    return (const char *) g_ptr_array_index (journal->blocks, block);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Start writing the journal. Data passed to copy_journal_update() then starts at the
+ * offset blocks * COPY_JOURNAL_BLOCK_SIZE.
+ *
+ * @param journal journal
+ * @param blocks number of blocks already copied, their checksums are kept
+ *
+ * @return TRUE on success, FALSE if the journal can't be written
+ */
+
+gboolean
+copy_journal_start (copy_journal_t * journal, guint blocks)
+{
+    guint i;
+
+    if (blocks < journal->blocks->len)
+        g_ptr_array_set_size (journal->blocks, blocks);
+
+    journal->f = fopen (journal->name, "w");
+    if (journal->f == NULL)
+        return FALSE;
+
+    fputs (journal->header, journal->f);
+    for (i = 0; i < journal->blocks->len; i++)
+        fprintf (journal->f, "%s\n", copy_journal_get_block (journal, i));
+
+    if (fflush (journal->f) != 0)
+    {
+        fclose (journal->f);
+        journal->f = NULL;
+        unlink (journal->name);
+        return FALSE;
+    }
+
+    journal->sum = g_checksum_new (G_CHECKSUM_MD5);
+    journal->fill = 0;
+
+    return TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Account copied data and record checksums of completed blocks.
+ *
+ * @param journal journal
+ * @param buf copied data
+ * @param len length of data
+ */
+
+void
+copy_journal_update (copy_journal_t * journal, const void *buf, size_t len)
+{
+    const guchar *p = (const guchar *) buf;
+
+    if (journal->f == NULL)
+        return;
+
+    while (len != 0)
+    {
+        size_t n;
+
+        n = (size_t) MIN ((off_t) len, COPY_JOURNAL_BLOCK_SIZE - journal->fill);
+        g_checksum_update (journal->sum, p, n);
+        journal->fill += n;
+        p += n;
+        len -= n;
+
+        if (journal->fill == COPY_JOURNAL_BLOCK_SIZE)
+        {
+            const char *block;
+
+            block = g_checksum_get_string (journal->sum);
+            g_ptr_array_add (journal->blocks, g_strdup (block));
+
+            /* a checkpoint: the journal survives the crash of mc */
+            fprintf (journal->f, "%s\n", block);
+            fflush (journal->f);
+
+            g_checksum_reset (journal->sum);
+            journal->fill = 0;
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
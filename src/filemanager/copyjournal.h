@@ -0,0 +1,43 @@
+/** \file copyjournal.h
+ *  \brief Header: checkpoint journal of file copying
+ */
+
+#ifndef MC__COPYJOURNAL_H
+#define MC__COPYJOURNAL_H
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "lib/global.h"
+
+/*** typedefs(not structures) and defined constants **********************************************/
+
+/* files smaller than this are copied without journal */
+#define COPY_JOURNAL_MIN_SIZE ((off_t) 64 * 1024 * 1024)
+
+/* size of block which checksum is recorded */
+#define COPY_JOURNAL_BLOCK_SIZE ((off_t) 16 * 1024 * 1024)
+
+/*** enums ***************************************************************************************/
+
+/*** structures declarations (and typedefs of structures)*****************************************/
+
+typedef struct copy_journal_struct copy_journal_t;
+
+/*** global variables defined in .c file *********************************************************/
+
+/*** declarations of public functions ************************************************************/
+
+copy_journal_t *copy_journal_new (const char *src_path, const char *dst_path,
+                                  const struct stat *src_st);
+void copy_journal_free (copy_journal_t * journal, gboolean remove);
+
+guint copy_journal_get_blocks (const copy_journal_t * journal);
+const char *copy_journal_get_block (const copy_journal_t * journal, guint block);
+
+gboolean copy_journal_start (copy_journal_t * journal, guint blocks);
+void copy_journal_update (copy_journal_t * journal, const void *buf, size_t len);
+
+/*** inline functions ****************************************************************************/
+
+#endif /* MC__COPYJOURNAL_H */
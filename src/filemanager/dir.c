@@ -72,7 +72,14 @@ static int case_sensitive = OS_SORT_CASE_SENSITIVE_DEFAULT;
 /* Are the exec_bit files top in list */
 static gboolean exec_first = TRUE;
 
-static dir_list dir_copy = { NULL, 0, 0 };
+/* sort function used by dir_list_sort() */
+static GCompareFunc sort_fn = NULL;
+
+/* collation keys are created lazily while sorting and are indexed by position of entry
+   relative to sort_base, so they don't take place in every file_entry_t */
+static const file_entry_t *sort_base = NULL;
+static char **sort_keys = NULL;
+static char **second_sort_keys = NULL;
 
 /*** file scope functions ************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
@@ -117,26 +124,49 @@ key_collate (const char *t1, const char *t2)
     return ret;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Allocate empty keys for entries to be sorted, should be called before sorting is started.
+ */
+
+static void
+init_sort_keys (const file_entry_t * entries, int count)
+{
+    sort_base = entries;
+    sort_keys = g_new0 (char *, count);
+    second_sort_keys = g_new0 (char *, count);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /**
  * clear keys, should be call after sorting is finished.
  */
 
 static void
-clean_sort_keys (dir_list * list, int start, int count)
+clean_sort_keys (int count)
 {
     int i;
 
     for (i = 0; i < count; i++)
     {
-        file_entry_t *fentry;
-
-        fentry = &list->list[i + start];
-        str_release_key (fentry->sort_key, case_sensitive);
-        fentry->sort_key = NULL;
-        str_release_key (fentry->second_sort_key, case_sensitive);
-        fentry->second_sort_key = NULL;
+        str_release_key (sort_keys[i], case_sensitive);
+        str_release_key (second_sort_keys[i], case_sensitive);
     }
+
+    MC_PTR_FREE (sort_keys);
+    MC_PTR_FREE (second_sort_keys);
+    sort_base = NULL;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Compare entries referenced by the elements of array of pointers.
+ */
+
+static int
+sort_order_cmp (const void *a, const void *b)
+{
+    return sort_fn (*(file_entry_t * const *) a, *(file_entry_t * const *) b);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -220,28 +250,197 @@ dir_get_dotdot_stat (const vfs_path_t * vpath, struct stat *st)
 /* --------------------------------------------------------------------------------------------- */
 
 static void
-alloc_dir_copy (int size)
+dir_list_set_sort_options (dir_list * list, GCompareFunc sort, const dir_sort_options_t * sort_op)
+{
+    reverse = sort_op->reverse ? -1 : 1;
+    case_sensitive = sort_op->case_sensitive ? 1 : 0;
+    exec_first = sort_op->exec_first;
+
+    /* remember the order of list */
+    list->sort = sort;
+    list->sort_op = *sort_op;
+    list->sort_mix_all_files = panels_options.mix_all_files;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Reorder entries of list.
+ *
+ * @param entries array of entries
+ * @param order array of pointers to entries in the new order. It is destroyed on return
+ * @param n number of entries
+ */
+
+static void
+dir_list_apply_order (file_entry_t * entries, file_entry_t ** order, int n)
 {
-    if (dir_copy.size < size)
+    int i;
+
+    /* every entry is moved once following the cycles of permutation */
+    for (i = 0; i < n; i++)
     {
-        if (dir_copy.list != NULL)
+        file_entry_t tmp;
+        int j;
+
+        if (order[i] == &entries[i])
+            continue;
+
+        tmp = entries[i];
+
+        for (j = i;;)
         {
-            int i;
+            int k;
 
-            for (i = 0; i < dir_copy.len; i++)
+            k = order[j] - entries;
+            order[j] = &entries[j];
+            if (k == i)
             {
-                file_entry_t *fentry;
-
-                fentry = &(dir_copy.list)[i];
-                g_free (fentry->fname);
+                entries[j] = tmp;
+                break;
             }
-            g_free (dir_copy.list);
+            entries[j] = entries[k];
+            j = k;
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check whether entries are sorted in the same way by any sort function.
+ */
+
+static inline gboolean
+dir_entry_same_order (const file_entry_t * a, const file_entry_t * b)
+{
+    return (a->f.link_to_dir == b->f.link_to_dir && a->st.st_mode == b->st.st_mode
+            && a->st.st_size == b->st.st_size && a->st.st_mtime == b->st.st_mtime
+            && a->st.st_atime == b->st.st_atime && a->st.st_ctime == b->st.st_ctime
+            && a->st.st_ino == b->st.st_ino);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Sort reloaded list which entries keep the order of the old list.
+ * Entries which are not found in the old list are sorted and inserted among kept ones.
+ *
+ * @param list reloaded directory list
+ * @param old_index index of entry of old list for every entry of list, -1 if entry is new
+ * @param old_len length of old list
+ * @param sort sort function
+ * @param sort_op sort options
+ */
+
+static void
+dir_list_sort_changed (dir_list * list, const int *old_index, int old_len, GCompareFunc sort,
+                       const dir_sort_options_t * sort_op)
+{
+    file_entry_t *entries, **kept, **fresh, **order;
+    int *pos;
+    int dot_dot_found, n, nkept = 0, nfresh = 0;
+    int i, k, m;
+
+    dot_dot_found = (list->len != 0 && DIR_IS_DOTDOT (list->list[0].fname)) ? 1 : 0;
+    entries = &list->list[dot_dot_found];
+    old_index += dot_dot_found;
+    n = list->len - dot_dot_found;
+
+    dir_list_set_sort_options (list, sort, sort_op);
+
+    if (n < 2)
+        return;
+
+    pos = g_new (int, old_len);
+    for (i = 0; i < old_len; i++)
+        pos[i] = -1;
+
+    fresh = g_new (file_entry_t *, n);
+    for (i = 0; i < n; i++)
+    {
+        if (old_index[i] >= 0 && pos[old_index[i]] < 0)
+            pos[old_index[i]] = i;
+        else
+            fresh[nfresh++] = &entries[i];
+    }
+
+    /* entries from the old list are already sorted */
+    kept = g_new (file_entry_t *, n - nfresh);
+    for (i = 0; i < old_len; i++)
+        if (pos[i] >= 0)
+            kept[nkept++] = &entries[pos[i]];
+
+    init_sort_keys (entries, n);
+    sort_fn = sort;
+    qsort (fresh, nfresh, sizeof (file_entry_t *), sort_order_cmp);
+
+    /* insert new entries using binary search */
+    order = g_new (file_entry_t *, n);
+    for (i = 0, k = 0, m = 0; i < nfresh; i++)
+    {
+        int lo = m, hi = nkept;
+
+        while (lo < hi)
+        {
+            int mid;
+
+            mid = lo + (hi - lo) / 2;
+            if (sort_fn (kept[mid], fresh[i]) <= 0)
+                lo = mid + 1;
+            else
+                hi = mid;
         }
 
-        dir_copy.list = g_new0 (file_entry_t, size);
-        dir_copy.size = size;
-        dir_copy.len = 0;
+        while (m < lo)
+            order[k++] = kept[m++];
+        order[k++] = fresh[i];
     }
+    while (m < nkept)
+        order[k++] = kept[m++];
+
+    sort_fn = NULL;
+
+    dir_list_apply_order (entries, order, n);
+
+    g_free (order);
+    g_free (kept);
+    g_free (fresh);
+    g_free (pos);
+
+    clean_sort_keys (n);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Append entry of file of directory to the directory list if the file exists and is shown.
+ *
+ * @param list directory list
+ * @param vpath directory the list is read from
+ * @param fname name of file in the directory
+ * @param fltr file name filter, NULL if all files are shown
+ */
+
+static void
+dir_list_append_file (dir_list * list, const vfs_path_t * vpath, const char *fname,
+                      const char *fltr)
+{
+    vfs_path_t *tmp_vpath;
+    struct stat st;
+    int link_to_dir, stale_link;
+    gboolean ok;
+
+    if (DIR_IS_DOT (fname) || DIR_IS_DOTDOT (fname))
+        return;
+    if (!panels_options.show_dot_files && fname[0] == '.')
+        return;
+    if (!panels_options.show_backups && fname[strlen (fname) - 1] == '~')
+        return;
+
+    tmp_vpath = vfs_path_append_new (vpath, fname, NULL);
+    ok = handle_path (vfs_path_as_str (tmp_vpath), &st, &link_to_dir, &stale_link);
+    vfs_path_free (tmp_vpath);
+
+    if (ok && (S_ISDIR (st.st_mode) || link_to_dir != 0 || fltr == NULL
+               || mc_search (fltr, NULL, fname, MC_SEARCH_T_GLOB)))
+        dir_list_append (list, fname, &st, link_to_dir != 0, stale_link != 0);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -292,6 +491,32 @@ dir_list_grow (dir_list * list, int delta)
     return TRUE;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Copy file name to the storage of directory list.
+ *
+ * Names are allocated in big blocks and are freed all at once by dir_list_clean(),
+ * so entries of list must not free them.
+ *
+ * @param list directory list
+ * @param fname file name
+ * @param len length of file name
+ *
+ * @return newly allocated copy of file name owned by list
+ */
+
+char *
+dir_list_name_new (dir_list * list, const char *fname, size_t len)
+{
+    if (list->names == NULL)
+        list->names = g_string_chunk_new (DIR_LIST_NAMES_BLOCK_SIZE);
+
+    /* keep the total to get memory usage without walking through the list */
+    list->names_size += len + 1;
+
+    return g_string_chunk_insert_len (list->names, fname, (gssize) len);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /**
  * Append file info to the directory list.
@@ -317,16 +542,16 @@ dir_list_append (dir_list * list, const char *fname, const struct stat * st,
 
     fentry = &list->list[list->len];
     fentry->fnamelen = strlen (fname);
-    fentry->fname = g_strndup (fname, fentry->fnamelen);
+    fentry->fname = dir_list_name_new (list, fname, fentry->fnamelen);
     fentry->f.marked = 0;
     fentry->f.link_to_dir = link_to_dir ? 1 : 0;
     fentry->f.stale_link = stale_link ? 1 : 0;
     fentry->f.dir_size_computed = 0;
     fentry->st = *st;
-    fentry->sort_key = NULL;
-    fentry->second_sort_key = NULL;
+    fentry->fhl_id = 0;
 
     list->len++;
+    list->sort = NULL;
 
     return TRUE;
 }
@@ -351,13 +576,16 @@ sort_name (file_entry_t * a, file_entry_t * b)
 
     if (ad == bd || panels_options.mix_all_files)
     {
+        char **akey = &sort_keys[a - sort_base];
+        char **bkey = &sort_keys[b - sort_base];
+
         /* create key if does not exist, key will be freed after sorting */
-        if (a->sort_key == NULL)
-            a->sort_key = str_create_key_for_filename (a->fname, case_sensitive);
-        if (b->sort_key == NULL)
-            b->sort_key = str_create_key_for_filename (b->fname, case_sensitive);
+        if (*akey == NULL)
+            *akey = str_create_key_for_filename (a->fname, case_sensitive);
+        if (*bkey == NULL)
+            *bkey = str_create_key_for_filename (b->fname, case_sensitive);
 
-        return key_collate (a->sort_key, b->sort_key);
+        return key_collate (*akey, *bkey);
     }
     return bd - ad;
 }
@@ -390,14 +618,16 @@ sort_ext (file_entry_t * a, file_entry_t * b)
 
     if (ad == bd || panels_options.mix_all_files)
     {
+        char **akey = &second_sort_keys[a - sort_base];
+        char **bkey = &second_sort_keys[b - sort_base];
         int r;
 
-        if (a->second_sort_key == NULL)
-            a->second_sort_key = str_create_key (extension (a->fname), case_sensitive);
-        if (b->second_sort_key == NULL)
-            b->second_sort_key = str_create_key (extension (b->fname), case_sensitive);
+        if (*akey == NULL)
+            *akey = str_create_key (extension (a->fname), case_sensitive);
+        if (*bkey == NULL)
+            *bkey = str_create_key (extension (b->fname), case_sensitive);
 
-        r = str_key_collate (a->second_sort_key, b->second_sort_key, case_sensitive);
+        r = str_key_collate (*akey, *bkey, case_sensitive);
         if (r)
             return r * reverse;
         else
@@ -505,8 +735,11 @@ sort_size (file_entry_t * a, file_entry_t * b)
 void
 dir_list_sort (dir_list * list, GCompareFunc sort, const dir_sort_options_t * sort_op)
 {
-    file_entry_t *fentry;
+    file_entry_t *fentry, *entries, **order;
     int dot_dot_found = 0;
+    int i, n;
+
+    dir_list_set_sort_options (list, sort, sort_op);
 
     if (list->len < 2 || sort == (GCompareFunc) unsorted)
         return;
@@ -517,12 +750,24 @@ dir_list_sort (dir_list * list, GCompareFunc sort, const dir_sort_options_t * so
     if (DIR_IS_DOTDOT (fentry->fname))
         dot_dot_found = 1;
 
-    reverse = sort_op->reverse ? -1 : 1;
-    case_sensitive = sort_op->case_sensitive ? 1 : 0;
-    exec_first = sort_op->exec_first;
-    qsort (&(list->list)[dot_dot_found], list->len - dot_dot_found, sizeof (file_entry_t), sort);
+    entries = &list->list[dot_dot_found];
+    n = list->len - dot_dot_found;
+
+    /* entries are large, so sort an array of pointers to them */
+    order = g_new (file_entry_t *, n);
+    for (i = 0; i < n; i++)
+        order[i] = &entries[i];
+
+    init_sort_keys (entries, n);
+    sort_fn = sort;
+    qsort (order, n, sizeof (file_entry_t *), sort_order_cmp);
+    sort_fn = NULL;
+
+    dir_list_apply_order (entries, order, n);
+
+    g_free (order);
 
-    clean_sort_keys (list, dot_dot_found, list->len - dot_dot_found);
+    clean_sort_keys (n);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -530,19 +775,53 @@ dir_list_sort (dir_list * list, GCompareFunc sort, const dir_sort_options_t * so
 void
 dir_list_clean (dir_list * list)
 {
-    int i;
+    /* all names are freed at once */
+    if (list->names != NULL)
+        g_string_chunk_clear (list->names);
+    list->names_size = 0;
 
-    for (i = 0; i < list->len; i++)
-    {
-        file_entry_t *fentry;
+    list->len = 0;
+    list->sort = NULL;
+    /* reduce memory usage */
+    dir_list_grow (list, DIR_LIST_MIN_SIZE - list->size);
+}
 
-        fentry = &list->list[i];
-        MC_PTR_FREE (fentry->fname);
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Free all memory used by directory list.
+ *
+ * @param list directory list
+ */
+
+void
+dir_list_free_list (dir_list * list)
+{
+    if (list->names != NULL)
+    {
+        g_string_chunk_free (list->names);
+        list->names = NULL;
     }
+    list->names_size = 0;
 
+    MC_PTR_FREE (list->list);
+    list->size = 0;
     list->len = 0;
-    /* reduce memory usage */
-    dir_list_grow (list, DIR_LIST_MIN_SIZE - list->size);
+    list->sort = NULL;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get amount of memory used by directory list.
+ *
+ * @param list directory list
+ *
+ * @return size of entries and their names in bytes
+ */
+
+size_t
+dir_list_get_mem_usage (const dir_list * list)
+{
+    return (size_t) list->size * sizeof (file_entry_t) + list->names_size;
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -563,13 +842,14 @@ dir_list_init (dir_list * list)
     fentry = &list->list[0];
     memset (fentry, 0, sizeof (file_entry_t));
     fentry->fnamelen = 2;
-    fentry->fname = g_strndup ("..", fentry->fnamelen);
+    fentry->fname = dir_list_name_new (list, "..", fentry->fnamelen);
     fentry->f.link_to_dir = 0;
     fentry->f.stale_link = 0;
     fentry->f.dir_size_computed = 0;
     fentry->f.marked = 0;
     fentry->st.st_mode = 040755;
     list->len = 1;
+    list->sort = NULL;
     return TRUE;
 }
 
@@ -696,8 +976,10 @@ dir_list_reload (dir_list * list, const vfs_path_t * vpath, GCompareFunc sort,
     struct dirent *dp;
     int i, link_to_dir, stale_link;
     struct stat st;
-    int marked_cnt;
-    GHashTable *marked_files;
+    dir_list old;
+    GHashTable *old_names;
+    GArray *old_index;
+    gboolean keep_order;
     const char *tmp_path;
 
     dirp = mc_opendir (vpath);
@@ -711,32 +993,26 @@ dir_list_reload (dir_list * list, const vfs_path_t * vpath, GCompareFunc sort,
 
     tree_store_start_check (vpath);
 
-    marked_files = g_hash_table_new (g_str_hash, g_str_equal);
-    alloc_dir_copy (list->len);
-    for (marked_cnt = i = 0; i < list->len; i++)
-    {
-        file_entry_t *fentry, *dfentry;
-
-        fentry = &list->list[i];
-        dfentry = &dir_copy.list[i];
-
-        dfentry->fnamelen = fentry->fnamelen;
-        dfentry->fname = g_strndup (fentry->fname, fentry->fnamelen);
-        dfentry->f.marked = fentry->f.marked;
-        dfentry->f.dir_size_computed = fentry->f.dir_size_computed;
-        dfentry->f.link_to_dir = fentry->f.link_to_dir;
-        dfentry->f.stale_link = fentry->f.stale_link;
-        dfentry->sort_key = NULL;
-        dfentry->second_sort_key = NULL;
-        if (fentry->f.marked)
-        {
-            g_hash_table_insert (marked_files, dfentry->fname, dfentry);
-            marked_cnt++;
-        }
-    }
+    /* If the old list is sorted in the same way, unchanged entries keep their order
+       and only new and changed ones should be sorted */
+    keep_order = list->sort != NULL && list->sort == sort && sort != (GCompareFunc) unsorted
+        && list->sort_op.reverse == sort_op->reverse
+        && list->sort_op.case_sensitive == sort_op->case_sensitive
+        && list->sort_op.exec_first == sort_op->exec_first
+        && list->sort_mix_all_files == panels_options.mix_all_files;
+
+    /* keep the old list to match new entries against it */
+    old = *list;
+    list->list = NULL;
+    list->names = NULL;
+    list->names_size = 0;
+    list->size = 0;
+    list->len = 0;
 
-    /* save len for later dir_list_clean() */
-    dir_copy.len = list->len;
+    old_names = g_hash_table_new (g_str_hash, g_str_equal);
+    for (i = 0; i < old.len; i++)
+        if (!DIR_IS_DOTDOT (old.list[i].fname))
+            g_hash_table_insert (old_names, old.list[i].fname, GINT_TO_POINTER (i + 1));
 
     /* Add ".." except to the root directory. The ".." entry
        (if any) must be the first in the list. */
@@ -744,14 +1020,16 @@ dir_list_reload (dir_list * list, const vfs_path_t * vpath, GCompareFunc sort,
     if (vfs_path_elements_count (vpath) == 1 && IS_PATH_SEP (tmp_path[0]) && tmp_path[1] == '\0')
     {
         /* root directory */
-        dir_list_clean (list);
+        dir_list_grow (list, DIR_LIST_MIN_SIZE);
     }
     else
     {
-        dir_list_clean (list);
         if (!dir_list_init (list))
         {
-            dir_list_clean (&dir_copy);
+            mc_closedir (dirp);
+            tree_store_end_check ();
+            g_hash_table_destroy (old_names);
+            dir_list_free_list (&old);
             return;
         }
 
@@ -761,12 +1039,22 @@ dir_list_reload (dir_list * list, const vfs_path_t * vpath, GCompareFunc sort,
 
             fentry = &list->list[0];
             fentry->st = st;
+            fentry->fhl_id = 0;
         }
     }
 
+    old_index = g_array_sized_new (FALSE, FALSE, sizeof (int), old.len + 1);
+    for (i = 0; i < list->len; i++)
+    {
+        int none = -1;
+
+        g_array_append_val (old_index, none);
+    }
+
     while ((dp = mc_readdir (dirp)) != NULL)
     {
         file_entry_t *fentry;
+        int j;
 
         if (!handle_dirent (dp, fltr, &st, &link_to_dir, &stale_link))
             continue;
@@ -774,46 +1062,126 @@ dir_list_reload (dir_list * list, const vfs_path_t * vpath, GCompareFunc sort,
         if (!dir_list_append (list, dp->d_name, &st, link_to_dir != 0, stale_link != 0))
         {
             mc_closedir (dirp);
-            /* Norbert (Feb 12, 1997):
-               Just in case someone finds this memory leak:
-               -1 means big trouble (at the moment no memory left),
-               I don't bother with further cleanup because if one gets to
-               this point he will have more problems than a few memory
-               leaks and because one 'dir_list_clean' would not be enough (and
-               because I don't want to spent the time to make it working,
-               IMHO it's not worthwhile).
-               dir_list_clean (&dir_copy);
-             */
             tree_store_end_check ();
-            g_hash_table_destroy (marked_files);
+            g_hash_table_destroy (old_names);
+            g_array_free (old_index, TRUE);
+            dir_list_free_list (&old);
             return;
         }
         fentry = &list->list[list->len - 1];
 
-        fentry->f.marked = 0;
-
-        /*
-         * If we have marked files in the copy, scan through the copy
-         * to find matching file.  Decrease number of remaining marks if
-         * we copied one.
-         */
-        if (marked_cnt > 0 && g_hash_table_lookup (marked_files, dp->d_name) != NULL)
+        /* find the same file in the old list to keep mark and position of it */
+        j = GPOINTER_TO_INT (g_hash_table_lookup (old_names, dp->d_name)) - 1;
+        if (j >= 0)
         {
-            fentry->f.marked = 1;
-            marked_cnt--;
+            fentry->f.marked = old.list[j].f.marked;
+            if (!dir_entry_same_order (fentry, &old.list[j]))
+                j = -1;
         }
+        g_array_append_val (old_index, j);
 
         if ((list->len & 15) == 0)
             rotate_dash (TRUE);
     }
     mc_closedir (dirp);
     tree_store_end_check ();
-    g_hash_table_destroy (marked_files);
+    g_hash_table_destroy (old_names);
 
-    dir_list_sort (list, sort, sort_op);
+    if (keep_order)
+        dir_list_sort_changed (list, (int *) old_index->data, old.len, sort, sort_op);
+    else
+        dir_list_sort (list, sort, sort_op);
 
-    dir_list_clean (&dir_copy);
+    g_array_free (old_index, TRUE);
+    dir_list_free_list (&old);
     rotate_dash (FALSE);
 }
 
 /* --------------------------------------------------------------------------------------------- */
+/**
+ * Read again entries of files which were created, deleted or changed in the directory.
+ * Entries of gone files are removed, unchanged entries keep their order and entries of
+ * changed files are sorted and merged among them in one pass. If the order of list is
+ * unknown, entries of changed files are appended to the end of list.
+ *
+ * @param list directory list
+ * @param vpath directory the list is read from
+ * @param fnames set of names of changed files in the directory
+ * @param fltr file name filter, NULL if all files are shown
+ * @param selected index of current entry. On return, index of the same file or, if the file
+ *                 is gone, of the entry near its place
+ */
+
+void
+dir_list_update_files (dir_list * list, const vfs_path_t * vpath, GHashTable * fnames,
+                       const char *fltr, int *selected)
+{
+    GCompareFunc sort;
+    dir_sort_options_t sort_op;
+    gboolean sort_mix_all_files;
+    const char *sel_name = NULL;
+    int sel_pos = 0;
+    GHashTableIter iter;
+    gpointer key;
+    int i, j, nkept;
+
+    /* dir_list_append() forgets the order of list */
+    sort = list->sort;
+    sort_op = list->sort_op;
+    sort_mix_all_files = list->sort_mix_all_files;
+
+    /* remove entries of changed files, names stay in the storage until list is cleaned */
+    for (i = 0, j = 0; i < list->len; i++)
+    {
+        if (i == *selected)
+        {
+            sel_name = list->list[i].fname;
+            sel_pos = j;
+        }
+
+        if (!g_hash_table_lookup_extended (fnames, list->list[i].fname, NULL, NULL))
+        {
+            if (j != i)
+                list->list[j] = list->list[i];
+            j++;
+        }
+    }
+
+    list->len = nkept = j;
+
+    g_hash_table_iter_init (&iter, fnames);
+    while (g_hash_table_iter_next (&iter, &key, NULL))
+        dir_list_append_file (list, vpath, (const char *) key, fltr);
+
+    if (sort != NULL && sort_mix_all_files == panels_options.mix_all_files)
+    {
+        if (list->len == nkept || sort == (GCompareFunc) unsorted)
+            dir_list_set_sort_options (list, sort, &sort_op);
+        else
+        {
+            int *old_index;
+
+            /* kept entries are already sorted */
+            old_index = g_new (int, list->len);
+            for (i = 0; i < list->len; i++)
+                old_index[i] = i < nkept ? i : -1;
+
+            dir_list_sort_changed (list, old_index, nkept, sort, &sort_op);
+            g_free (old_index);
+        }
+    }
+
+    if (sel_name != NULL)
+    {
+        for (i = 0; i < list->len; i++)
+            if (strcmp (list->list[i].fname, sel_name) == 0)
+                break;
+
+        if (i == list->len)
+            i = MIN (sel_pos, list->len - 1);
+
+        *selected = MAX (i, 0);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
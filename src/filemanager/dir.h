@@ -15,21 +15,13 @@
 
 #define DIR_LIST_MIN_SIZE 128
 #define DIR_LIST_RESIZE_STEP 128
+/* size of blocks of file name storage */
+#define DIR_LIST_NAMES_BLOCK_SIZE 4096
 
 /*** enums ***************************************************************************************/
 
 /*** structures declarations (and typedefs of structures)*****************************************/
 
-/**
- * A structure to represent directory content
- */
-typedef struct
-{
-    file_entry_t *list; /**< list of file_entry_t objects */
-    int size;           /**< number of allocated elements in list (capacity) */
-    int len;            /**< number of used elements in list */
-} dir_list;
-
 /**
  * A structure to represent sort options for directory content
  */
@@ -40,11 +32,27 @@ typedef struct dir_sort_options_struct
     gboolean exec_first;        /**< executables are at top of list */
 } dir_sort_options_t;
 
+/**
+ * A structure to represent directory content
+ */
+typedef struct
+{
+    file_entry_t *list; /**< list of file_entry_t objects */
+    int size;           /**< number of allocated elements in list (capacity) */
+    int len;            /**< number of used elements in list */
+    GCompareFunc sort;  /**< sort function the list is ordered by, NULL if order is unknown */
+    dir_sort_options_t sort_op; /**< sort options the list is ordered by */
+    gboolean sort_mix_all_files;        /**< directories are mixed with files in the order */
+    GStringChunk *names;        /**< storage of file names of entries */
+    size_t names_size;          /**< number of bytes taken by names in the storage */
+} dir_list;
+
 /*** global variables defined in .c file *********************************************************/
 
 /*** declarations of public functions ************************************************************/
 
 gboolean dir_list_grow (dir_list * list, int delta);
+char *dir_list_name_new (dir_list * list, const char *fname, size_t len);
 gboolean dir_list_append (dir_list * list, const char *fname, const struct stat *st,
                           gboolean link_to_dir, gboolean stale_link);
 
@@ -55,7 +63,11 @@ void dir_list_reload (dir_list * list, const vfs_path_t * vpath, GCompareFunc so
 void dir_list_sort (dir_list * list, GCompareFunc sort, const dir_sort_options_t * sort_op);
 gboolean dir_list_init (dir_list * list);
 void dir_list_clean (dir_list * list);
+void dir_list_free_list (dir_list * list);
+size_t dir_list_get_mem_usage (const dir_list * list);
 gboolean handle_path (const char *path, struct stat *buf1, int *link_to_dir, int *stale_link);
+void dir_list_update_files (dir_list * list, const vfs_path_t * vpath, GHashTable * fnames,
+                            const char *fltr, int *selected);
 
 /* Sorting functions */
 int unsorted (file_entry_t * a, file_entry_t * b);
@@ -0,0 +1,347 @@
+/*
+   Cache of directory sizes.
+
+   Copyright (C) 2015
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file dirsize.c
+ *  \brief Source: cache of directory sizes
+ *
+ * The cache keeps the number and the size of files of every scanned local directory and
+ * the names of its subdirectories. Directories are identified by device and inode and
+ * an entry is valid while modification and change times of the directory are the same.
+ * Thus the size of unchanged subtree is computed by visiting its directories only.
+ *
+ * Writing into existing file doesn't change the times of its directory, so the cache is
+ * enabled by "cache_dir_sizes" option for trees which files are not modified in place.
+ *
+ * The cache is loaded on first use and saved on exit to the cache directory.
+ */
+
+#include <config.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lib/global.h"
+#include "lib/mcconfig.h"
+#include "lib/fileloc.h"
+#include "lib/strescape.h"
+#include "lib/util.h"
+
+#include "src/setup.h"          /* cache_dir_sizes */
+
+#include "dirsize.h"
+
+/*** global variables ****************************************************************************/
+
+/*** file scope macro definitions ****************************************************************/
+
+#define DIR_SIZE_SIGNATURE "MC dir sizes 1"
+
+/* entries unused for this time are not saved */
+#define DIR_SIZE_EXPIRE_TIME (30 * 24 * 60 * 60)
+
+/*** file scope type declarations ****************************************************************/
+
+/*** file scope variables ************************************************************************/
+
+/* dir_size_entry_t -> itself */
+static GHashTable *dir_sizes = NULL;
+static gboolean dir_sizes_dirty = FALSE;
+
+/*** file scope functions ************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+static guint
+dir_size_entry_hash (gconstpointer key)
+{
+    const dir_size_entry_t *e = (const dir_size_entry_t *) key;
+
+    return (guint) e->ino ^ (guint) e->dev;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static gboolean
+dir_size_entry_equal (gconstpointer a, gconstpointer b)
+{
+    const dir_size_entry_t *e1 = (const dir_size_entry_t *) a;
+    const dir_size_entry_t *e2 = (const dir_size_entry_t *) b;
+
+    return (e1->ino == e2->ino && e1->dev == e2->dev);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+dir_size_entry_free (gpointer data)
+{
+    dir_size_entry_t *e = (dir_size_entry_t *) data;
+
+    g_ptr_array_free (e->subdirs, TRUE);
+    g_free (e);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static char *
+dir_size_get_file_name (void)
+{
+    return g_build_filename (mc_config_get_cache_path (), MC_DIRSIZE_FILE, (char *) NULL);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+dir_size_cache_load (void)
+{
+    char *name;
+    FILE *f;
+    char buf[MC_MAXPATHLEN + 20];
+
+    dir_sizes = g_hash_table_new_full (dir_size_entry_hash, dir_size_entry_equal,
+                                       dir_size_entry_free, NULL);
+
+    name = dir_size_get_file_name ();
+    f = fopen (name, "r");
+    g_free (name);
+
+    if (f == NULL)
+        return;
+
+    if (fgets (buf, sizeof (buf), f) == NULL
+        || strncmp (buf, DIR_SIZE_SIGNATURE, strlen (DIR_SIZE_SIGNATURE)) != 0)
+    {
+        fclose (f);
+        return;
+    }
+
+    while (fgets (buf, sizeof (buf), f) != NULL)
+    {
+        uintmax_t dev, ino, bytes, files;
+        intmax_t mtime, ctime, used;
+        unsigned int n, i;
+        dir_size_entry_t *e;
+
+        if (sscanf (buf, "D %ju %ju %jd %jd %jd %ju %ju %u", &dev, &ino, &mtime, &ctime, &used,
+                    &files, &bytes, &n) != 8)
+            continue;
+
+        e = g_new (dir_size_entry_t, 1);
+        e->dev = (dev_t) dev;
+        e->ino = (ino_t) ino;
+        e->mtime = (time_t) mtime;
+        e->ctime = (time_t) ctime;
+        e->used = (time_t) used;
+        e->files = (size_t) files;
+        e->bytes = bytes;
+        e->subdirs = g_ptr_array_new_with_free_func (g_free);
+
+        for (i = 0; i < n && fgets (buf, sizeof (buf), f) != NULL; i++)
+        {
+            size_t len;
+
+            len = strlen (buf);
+            if (len != 0 && buf[len - 1] == '\n')
+                buf[--len] = '\0';
+            g_ptr_array_add (e->subdirs, strutils_unescape (buf, len, "\n\\", FALSE));
+        }
+
+        if (i == n)
+            g_hash_table_replace (dir_sizes, e, e);
+        else
+            dir_size_entry_free (e);
+    }
+
+    fclose (f);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static int
+dir_size_cache_save_to (const char *name)
+{
+    FILE *f;
+    GHashTableIter iter;
+    gpointer key;
+    time_t now;
+    int ret = 0;
+
+    f = fopen (name, "w");
+    if (f == NULL)
+        return errno;
+
+    fprintf (f, "%s\n", DIR_SIZE_SIGNATURE);
+
+    now = time (NULL);
+
+    g_hash_table_iter_init (&iter, dir_sizes);
+    while (ret == 0 && g_hash_table_iter_next (&iter, &key, NULL))
+    {
+        const dir_size_entry_t *e = (const dir_size_entry_t *) key;
+        guint i;
+
+        if (now - e->used > DIR_SIZE_EXPIRE_TIME)
+            continue;
+
+        if (fprintf (f, "D %ju %ju %jd %jd %jd %ju %ju %u\n", (uintmax_t) e->dev,
+                     (uintmax_t) e->ino, (intmax_t) e->mtime, (intmax_t) e->ctime,
+                     (intmax_t) e->used, (uintmax_t) e->files, e->bytes, e->subdirs->len) < 0)
+            ret = errno;
+
+        for (i = 0; ret == 0 && i < e->subdirs->len; i++)
+        {
+            char *encoded;
+
+            encoded =
+                strutils_escape (g_ptr_array_index (e->subdirs, i), -1, "\n\\", FALSE);
+            if (fprintf (f, "%s\n", encoded) < 0)
+                ret = errno;
+            g_free (encoded);
+        }
+    }
+
+    if (fclose (f) != 0 && ret == 0)
+        ret = errno;
+
+    return ret;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/*** public functions ****************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get cached contents of directory.
+ *
+ * @param st status of directory
+ *
+ * @return entry or NULL if the cache is disabled or directory is not cached or changed
+ */
+
+const dir_size_entry_t *
+dir_size_cache_get (const struct stat *st)
+{
+    dir_size_entry_t key;
+    dir_size_entry_t *e;
+
+    if (!cache_dir_sizes)
+        return NULL;
+
+    if (dir_sizes == NULL)
+        dir_size_cache_load ();
+
+    key.dev = st->st_dev;
+    key.ino = st->st_ino;
+
+    e = (dir_size_entry_t *) g_hash_table_lookup (dir_sizes, &key);
+    if (e == NULL)
+        return NULL;
+
+    if (e->mtime != st->st_mtime || e->ctime != st->st_ctime)
+    {
+        g_hash_table_remove (dir_sizes, e);
+        dir_sizes_dirty = TRUE;
+        return NULL;
+    }
+
+    e->used = time (NULL);
+    dir_sizes_dirty = TRUE;
+
+    return e;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Remember contents of directory.
+ *
+ * @param st status of directory got before it was read
+ * @param files number of non-directory entries
+ * @param bytes size of non-directory entries
+ * @param subdirs names of subdirectories. Array is owned by the cache after the call
+ */
+
+void
+dir_size_cache_put (const struct stat *st, size_t files, uintmax_t bytes, GPtrArray * subdirs)
+{
+    dir_size_entry_t *e;
+    time_t now;
+
+    now = time (NULL);
+
+    /* directory changed in the same second after it was read cannot be distinguished */
+    if (!cache_dir_sizes || st->st_mtime >= now - 1 || st->st_ctime >= now - 1)
+    {
+        g_ptr_array_free (subdirs, TRUE);
+        return;
+    }
+
+    if (dir_sizes == NULL)
+        dir_size_cache_load ();
+
+    e = g_new (dir_size_entry_t, 1);
+    e->dev = st->st_dev;
+    e->ino = st->st_ino;
+    e->mtime = st->st_mtime;
+    e->ctime = st->st_ctime;
+    e->used = now;
+    e->files = files;
+    e->bytes = bytes;
+    e->subdirs = subdirs;
+
+    g_hash_table_replace (dir_sizes, e, e);
+    dir_sizes_dirty = TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Save the cache and free it.
+ */
+
+void
+dir_size_cache_done (void)
+{
+    if (dir_sizes == NULL)
+        return;
+
+    if (dir_sizes_dirty)
+    {
+        char *name;
+
+        name = dir_size_get_file_name ();
+        mc_util_make_backup_if_possible (name, ".tmp");
+
+        if (dir_size_cache_save_to (name) == 0)
+            mc_util_unlink_backup_if_possible (name, ".tmp");
+        else
+            mc_util_restore_from_backup_if_possible (name, ".tmp");
+
+        g_free (name);
+    }
+
+    g_hash_table_destroy (dir_sizes);
+    dir_sizes = NULL;
+    dir_sizes_dirty = FALSE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,43 @@
+/** \file dirsize.h
+ *  \brief Header: cache of directory sizes
+ */
+
+#ifndef MC__DIRSIZE_H
+#define MC__DIRSIZE_H
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "lib/global.h"
+
+/*** typedefs(not structures) and defined constants **********************************************/
+
+/*** enums ***************************************************************************************/
+
+/*** structures declarations (and typedefs of structures)*****************************************/
+
+/* cached contents of one directory */
+typedef struct
+{
+    dev_t dev;
+    ino_t ino;
+    time_t mtime;
+    time_t ctime;
+    time_t used;                /* time of last use, unused entries are expired */
+    size_t files;               /* number of non-directory entries */
+    uintmax_t bytes;            /* size of non-directory entries */
+    GPtrArray *subdirs;         /* names of subdirectories */
+} dir_size_entry_t;
+
+/*** global variables defined in .c file *********************************************************/
+
+/*** declarations of public functions ************************************************************/
+
+const dir_size_entry_t *dir_size_cache_get (const struct stat *st);
+void dir_size_cache_put (const struct stat *st, size_t files, uintmax_t bytes,
+                         GPtrArray * subdirs);
+void dir_size_cache_done (void);
+
+/*** inline functions ****************************************************************************/
+
+#endif /* MC__DIRSIZE_H */
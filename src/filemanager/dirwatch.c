@@ -0,0 +1,521 @@
+/*
+   Watching of panel directories for changes.
+
+   Copyright (C) 2015
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file dirwatch.c
+ *  \brief Source: watching of panel directories for changes
+ *
+ * Local directories shown in the panels are watched with inotify. Events are read as soon
+ * as they come and only names of changed files are remembered. On the next idle event of
+ * the main dialog only entries of those files are updated in the panels, so the directory
+ * list is never changed under running file operation. The whole directory is reloaded
+ * only if events are lost or there are too many changes.
+ *
+ * Every directory is updated at most once per DIR_WATCH_DELAY. Changes came earlier are
+ * delayed by timer, so the last ones of the burst aren't lost.
+ */
+
+#include <config.h>
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#endif
+#ifdef HAVE_SYS_TIMERFD_H
+#include <sys/timerfd.h>
+#endif
+
+#include "lib/global.h"
+#include "lib/timer.h"
+#include "lib/tty/key.h"        /* add_select_channel(), delete_select_channel() */
+#include "lib/vfs/vfs.h"
+#include "lib/widget.h"
+
+#include "layout.h"             /* get_panel_widget() */
+#include "panel.h"
+#include "treestore.h"
+
+#include "dirwatch.h"
+
+/*** global variables ****************************************************************************/
+
+/*** file scope macro definitions ****************************************************************/
+
+#define DIR_WATCH_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB \
+                          | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+
+/* minimal interval between updates of directory, in microseconds */
+#define DIR_WATCH_DELAY G_USEC_PER_SEC
+
+/* if more files are changed, directory is reloaded */
+#define DIR_WATCH_MAX_FILES 1024
+
+/*** file scope type declarations ****************************************************************/
+
+typedef struct
+{
+    int wd;                     /* watch descriptor, -1 if watch is removed by kernel */
+    char *path;                 /* watched directory */
+    GHashTable *files;          /* names of changed files, NULL if there are no changes */
+    gboolean reload;            /* directory should be reloaded */
+    guint64 updated;            /* time of the last update of panels */
+} dir_watch_t;
+
+/*** file scope variables ************************************************************************/
+
+#ifdef HAVE_SYS_INOTIFY_H
+static int inotify_fd = -1;
+static GSList *watches = NULL;
+#ifdef HAVE_SYS_TIMERFD_H
+static int timer_fd = -1;
+#endif
+#endif
+
+/*** file scope functions ************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+#ifdef HAVE_SYS_INOTIFY_H
+static void
+dir_watch_free (dir_watch_t * w)
+{
+    /* the same directory can be watched under different names */
+    if (w->wd >= 0)
+    {
+        GSList *l;
+
+        for (l = watches; l != NULL; l = g_slist_next (l))
+            if (l->data != w && ((dir_watch_t *) l->data)->wd == w->wd)
+                break;
+
+        if (l == NULL)
+            inotify_rm_watch (inotify_fd, w->wd);
+    }
+
+    if (w->files != NULL)
+        g_hash_table_destroy (w->files);
+    g_free (w->path);
+    g_free (w);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static dir_watch_t *
+dir_watch_find (const char *path)
+{
+    GSList *l;
+
+    for (l = watches; l != NULL; l = g_slist_next (l))
+    {
+        dir_watch_t *w = (dir_watch_t *) l->data;
+
+        if (strcmp (w->path, path) == 0)
+            return w;
+    }
+
+    return NULL;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get path of directory shown in the panel if it can be watched.
+ *
+ * @param idx panel index
+ *
+ * @return path or NULL
+ */
+
+static const char *
+dir_watch_panel_path (int idx)
+{
+    WPanel *panel;
+
+    if (get_display_type (idx) != view_listing)
+        return NULL;
+
+    panel = PANEL (get_panel_widget (idx));
+    if (panel->is_panelized || !vfs_file_is_local (panel->cwd_vpath))
+        return NULL;
+
+    return vfs_path_as_str (panel->cwd_vpath);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+dir_watch_reset (dir_watch_t * w)
+{
+    if (w->files != NULL)
+    {
+        g_hash_table_destroy (w->files);
+        w->files = NULL;
+    }
+
+    w->reload = FALSE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+dir_watch_event (const struct inotify_event *ev)
+{
+    GSList *l;
+
+    for (l = watches; l != NULL; l = g_slist_next (l))
+    {
+        dir_watch_t *w = (dir_watch_t *) l->data;
+
+        if ((ev->mask & IN_Q_OVERFLOW) != 0)
+        {
+            /* events are lost: reload all */
+            dir_watch_reset (w);
+            w->reload = TRUE;
+            continue;
+        }
+
+        if (w->wd != ev->wd)
+            continue;
+
+        if ((ev->mask & IN_IGNORED) != 0)
+            w->wd = -1;
+
+        if ((ev->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) != 0)
+        {
+            /* directory itself is gone */
+            dir_watch_reset (w);
+            w->reload = TRUE;
+            continue;
+        }
+
+        /* events of directory itself don't change its list */
+        if (ev->len == 0 || ev->name[0] == '\0' || w->reload)
+            continue;
+
+        if ((ev->mask & IN_ISDIR) != 0
+            && (ev->mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)) != 0)
+        {
+            vfs_path_t *vpath;
+
+            if ((ev->mask & (IN_CREATE | IN_MOVED_TO)) != 0)
+            {
+                vpath = vfs_path_from_str (w->path);
+                tree_store_add_subdir (vpath, ev->name);
+            }
+            else
+            {
+                vpath = vfs_path_build_filename (w->path, ev->name, NULL);
+                tree_store_remove_entry (vpath);
+            }
+            vfs_path_free (vpath);
+        }
+
+        if (w->files == NULL)
+            w->files = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        else if (g_hash_table_size (w->files) >= DIR_WATCH_MAX_FILES)
+        {
+            /* reload is cheaper than so many updates */
+            dir_watch_reset (w);
+            w->reload = TRUE;
+            continue;
+        }
+
+        if (g_hash_table_lookup (w->files, ev->name) == NULL)
+        {
+            char *name;
+
+            name = g_strdup (ev->name);
+            g_hash_table_insert (w->files, name, name);
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static int
+dir_watch_callback (int fd, void *info)
+{
+    union
+    {
+        int align;
+        char buf[4096];
+    } events;
+    ssize_t len;
+    gboolean changed = FALSE;
+
+    (void) info;
+
+    while ((len = read (fd, events.buf, sizeof (events.buf))) > 0)
+    {
+        ssize_t i;
+
+        for (i = 0; i < len;)
+        {
+            const struct inotify_event *ev;
+
+            ev = (const struct inotify_event *) (events.buf + i);
+            dir_watch_event (ev);
+            i += sizeof (struct inotify_event) + ev->len;
+        }
+
+        changed = TRUE;
+    }
+
+    /* panels will be updated on idle */
+    if (changed)
+        widget_want_idle (WIDGET (midnight_dlg), TRUE);
+
+    return 0;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+#ifdef HAVE_SYS_TIMERFD_H
+static int
+dir_watch_timer_callback (int fd, void *info)
+{
+    guint64 expirations;
+
+    (void) info;
+
+    if (read (fd, &expirations, sizeof (expirations)) > 0)
+        widget_want_idle (WIDGET (midnight_dlg), TRUE);
+
+    return 0;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Wake up the main dialog after delay to update delayed directories.
+ *
+ * @param delay delay in microseconds
+ */
+
+static void
+dir_watch_timer_set (guint64 delay)
+{
+    struct itimerspec its;
+
+    memset (&its, 0, sizeof (its));
+    its.it_value.tv_sec = delay / G_USEC_PER_SEC;
+    its.it_value.tv_nsec = (delay % G_USEC_PER_SEC) * 1000;
+
+    timerfd_settime (timer_fd, 0, &its, NULL);
+}
+#endif /* HAVE_SYS_TIMERFD_H */
+
+/* --------------------------------------------------------------------------------------------- */
+
+static gboolean
+dir_watch_init (void)
+{
+    inotify_fd = inotify_init ();
+    if (inotify_fd == -1)
+        return FALSE;
+
+    fcntl (inotify_fd, F_SETFD, FD_CLOEXEC);
+    fcntl (inotify_fd, F_SETFL, fcntl (inotify_fd, F_GETFL) | O_NONBLOCK);
+    add_select_channel (inotify_fd, dir_watch_callback, NULL);
+
+#ifdef HAVE_SYS_TIMERFD_H
+    /* without timer updates aren't delayed */
+    timer_fd = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (timer_fd != -1)
+    {
+        fcntl (timer_fd, F_SETFD, FD_CLOEXEC);
+        add_select_channel (timer_fd, dir_watch_timer_callback, NULL);
+    }
+#endif
+
+    return TRUE;
+}
+#endif /* HAVE_SYS_INOTIFY_H */
+
+/* --------------------------------------------------------------------------------------------- */
+/*** public functions ****************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Watch directories shown in the panels and stop watching the rest ones.
+ */
+
+void
+dir_watch_sync (void)
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    const char *paths[2];
+    GSList *l, *next;
+    int i;
+
+    if (mc_global.mc_run_mode != MC_RUN_FULL || midnight_dlg == NULL)
+        return;
+
+    for (i = 0; i < 2; i++)
+        paths[i] = dir_watch_panel_path (i);
+
+    for (l = watches; l != NULL; l = next)
+    {
+        dir_watch_t *w = (dir_watch_t *) l->data;
+
+        next = g_slist_next (l);
+
+        if (w->wd < 0 || ((paths[0] == NULL || strcmp (w->path, paths[0]) != 0)
+                          && (paths[1] == NULL || strcmp (w->path, paths[1]) != 0)))
+        {
+            watches = g_slist_delete_link (watches, l);
+            dir_watch_free (w);
+        }
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        dir_watch_t *w;
+        int wd;
+
+        if (paths[i] == NULL || dir_watch_find (paths[i]) != NULL)
+            continue;
+
+        if (inotify_fd == -1 && !dir_watch_init ())
+            return;
+
+        wd = inotify_add_watch (inotify_fd, paths[i], DIR_WATCH_EVENTS);
+        if (wd == -1)
+            continue;
+
+        w = g_new (dir_watch_t, 1);
+        w->wd = wd;
+        w->path = g_strdup (paths[i]);
+        w->files = NULL;
+        w->reload = FALSE;
+        w->updated = 0;
+        watches = g_slist_prepend (watches, w);
+    }
+#endif /* HAVE_SYS_INOTIFY_H */
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Update panels which directories are changed. Directory updated less than DIR_WATCH_DELAY
+ * ago is delayed until timer expires.
+ *
+ * @return TRUE if any panel was updated, FALSE otherwise
+ */
+
+gboolean
+dir_watch_process (void)
+{
+    gboolean updated = FALSE;
+#ifdef HAVE_SYS_INOTIFY_H
+    const char *paths[2];
+    GSList *l;
+    guint64 now;
+#ifdef HAVE_SYS_TIMERFD_H
+    guint64 next = 0;
+#endif
+    int i;
+
+    for (i = 0; i < 2; i++)
+        paths[i] = dir_watch_panel_path (i);
+
+    now = mc_timer_elapsed (mc_global.timer);
+
+    for (l = watches; l != NULL; l = g_slist_next (l))
+    {
+        dir_watch_t *w = (dir_watch_t *) l->data;
+
+        if (!w->reload && w->files == NULL)
+            continue;
+
+#ifdef HAVE_SYS_TIMERFD_H
+        if (timer_fd != -1 && w->updated != 0 && now < w->updated + DIR_WATCH_DELAY)
+        {
+            /* too early: remember the nearest time */
+            if (next == 0 || w->updated + DIR_WATCH_DELAY < next)
+                next = w->updated + DIR_WATCH_DELAY;
+            continue;
+        }
+#endif
+
+        for (i = 0; i < 2; i++)
+        {
+            WPanel *panel;
+
+            if (paths[i] == NULL || strcmp (w->path, paths[i]) != 0)
+                continue;
+
+            panel = PANEL (get_panel_widget (i));
+
+            if (w->reload)
+                update_one_panel_widget (panel, UP_OPTIMIZE, UP_KEEPSEL);
+            else
+                panel_update_files (panel, w->files);
+
+            updated = TRUE;
+        }
+
+        dir_watch_reset (w);
+        w->updated = now;
+    }
+
+#ifdef HAVE_SYS_TIMERFD_H
+    if (next != 0)
+        dir_watch_timer_set (next - now);
+#endif
+
+    dir_watch_sync ();
+#endif /* HAVE_SYS_INOTIFY_H */
+
+    return updated;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+void
+dir_watch_done (void)
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    if (inotify_fd == -1)
+        return;
+
+#ifdef HAVE_SYS_TIMERFD_H
+    if (timer_fd != -1)
+    {
+        delete_select_channel (timer_fd);
+        close (timer_fd);
+        timer_fd = -1;
+    }
+#endif
+
+    delete_select_channel (inotify_fd);
+
+    while (watches != NULL)
+    {
+        dir_watch_t *w = (dir_watch_t *) watches->data;
+
+        watches = g_slist_delete_link (watches, watches);
+        dir_watch_free (w);
+    }
+
+    close (inotify_fd);
+    inotify_fd = -1;
+#endif /* HAVE_SYS_INOTIFY_H */
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,26 @@
+/** \file dirwatch.h
+ *  \brief Header: watching of panel directories for changes
+ */
+
+#ifndef MC__DIRWATCH_H
+#define MC__DIRWATCH_H
+
+#include "lib/global.h"
+
+/*** typedefs(not structures) and defined constants **********************************************/
+
+/*** enums ***************************************************************************************/
+
+/*** structures declarations (and typedefs of structures)*****************************************/
+
+/*** global variables defined in .c file *********************************************************/
+
+/*** declarations of public functions ************************************************************/
+
+void dir_watch_sync (void);
+gboolean dir_watch_process (void);
+void dir_watch_done (void);
+
+/*** inline functions ****************************************************************************/
+
+#endif /* MC__DIRWATCH_H */
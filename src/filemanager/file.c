@@ -53,6 +53,7 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -76,7 +77,9 @@
 #endif
 
 /* Needed for current_panel, other_panel and WTree */
+#include "copyjournal.h"
 #include "dir.h"
+#include "dirsize.h"
 #include "filegui.h"
 #include "filenot.h"
 #include "tree.h"
@@ -104,6 +107,15 @@ const char *op_names[3] = {
 #define FILEOP_UPDATE_INTERVAL 2
 #define FILEOP_STALLING_INTERVAL 4
 
+/* longest sleep of speed limiter, so that progress buttons are not blocked */
+#define COPY_THROTTLE_SLICE (G_USEC_PER_SEC / 10)
+
+/* amount of copied data after which it is dropped from the page cache */
+#define COPY_DROP_CACHE_STEP (8 * 1024 * 1024)
+
+/* progress of directory size computing is shown with 25 FPS rate */
+#define DIR_SIZE_UPDATE_INTERVAL (G_USEC_PER_SEC / 25)
+
 /*** file scope type declarations ****************************************************************/
 
 /* This is a hard link cache */
@@ -126,6 +138,24 @@ typedef enum
     DEST_FULL = 2               /* Created, fully copied */
 } dest_status_t;
 
+/* file with several hard links, counted by directory size computing */
+typedef struct
+{
+    dev_t dev;
+    ino_t ino;
+} dir_size_inode_t;
+
+/* state of local directory size computing */
+typedef struct
+{
+    dirsize_status_msg_t *dsm;
+    size_t *dir_count;
+    size_t *ret_marked;
+    uintmax_t *ret_total;
+    GString *path;              /* path of current entry */
+    GHashTable *inodes;         /* already counted files with several hard links */
+} dir_size_walk_t;
+
 /*
  * This array introduced to avoid translation problems. The former (op_names)
  * is assumed to be nouns, suitable in dialog box titles; this one should
@@ -187,6 +217,9 @@ static GSList *dest_dirs = NULL;
 
 static FileProgressStatus transform_error = FILE_CONT;
 
+/* time of the last update of directory size computing progress */
+static guint64 dir_size_update_time = 0;
+
 /* --------------------------------------------------------------------------------------------- */
 /*** file scope functions ************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
@@ -508,6 +541,274 @@ make_symlink (file_op_context_t * ctx, const char *src_path, const char *dst_pat
     return return_status;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check whether progress of directory size computing should be shown now.
+ * Progress is shown not faster than 25 FPS.
+ */
+
+static gboolean
+dir_size_update_is_due (dirsize_status_msg_t * dsm)
+{
+    return (STATUS_MSG (dsm)->update != NULL
+            && mc_time_elapsed (&dir_size_update_time, DIR_SIZE_UPDATE_INTERVAL));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static FileProgressStatus
+dir_size_show_progress (dirsize_status_msg_t * dsm, const vfs_path_t * vpath, size_t dir_count,
+                        uintmax_t total_size)
+{
+    status_msg_t *sm = STATUS_MSG (dsm);
+
+    dsm->dirname_vpath = vpath;
+    dsm->dir_count = dir_count;
+    dsm->total_size = total_size;
+    return sm->update (sm);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Show progress of directory size computing not faster than 25 FPS.
+ */
+
+static FileProgressStatus
+dir_size_update_progress (dirsize_status_msg_t * dsm, const vfs_path_t * vpath, size_t dir_count,
+                          uintmax_t total_size)
+{
+    if (!dir_size_update_is_due (dsm))
+        return FILE_CONT;
+
+    return dir_size_show_progress (dsm, vpath, dir_count, total_size);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+#if defined(HAVE_FSTATAT) && defined(HAVE_FDOPENDIR)
+static guint
+dir_size_inode_hash (gconstpointer key)
+{
+    const dir_size_inode_t *inode = (const dir_size_inode_t *) key;
+
+    return (guint) inode->ino ^ (guint) inode->dev;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static gboolean
+dir_size_inode_equal (gconstpointer a, gconstpointer b)
+{
+    const dir_size_inode_t *inode1 = (const dir_size_inode_t *) a;
+    const dir_size_inode_t *inode2 = (const dir_size_inode_t *) b;
+
+    return (inode1->ino == inode2->ino && inode1->dev == inode2->dev);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+dir_size_walk_enter (dir_size_walk_t * walk, const char *name)
+{
+    if (walk->path->len == 0 || walk->path->str[walk->path->len - 1] != PATH_SEP)
+        g_string_append_c (walk->path, PATH_SEP);
+    g_string_append (walk->path, name);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+ * Show progress of directory size computing. Path of current entry is converted to vpath
+ * only when the progress is really shown, not for every entry.
+ */
+
+static FileProgressStatus
+dir_size_walk_progress (dir_size_walk_t * walk)
+{
+    vfs_path_t *vpath;
+    FileProgressStatus ret;
+
+    if (!dir_size_update_is_due (walk->dsm))
+        return FILE_CONT;
+
+    vpath = vfs_path_from_str (walk->path->str);
+    ret = dir_size_show_progress (walk->dsm, vpath, *walk->dir_count, *walk->ret_total);
+    vfs_path_free (vpath);
+
+    return ret;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static FileProgressStatus do_compute_dir_size_at (int dir_fd, dir_size_walk_t * walk);
+
+static FileProgressStatus
+dir_size_walk_subdir (int dir_fd, const char *name, dir_size_walk_t * walk)
+{
+    int fd;
+
+    (*walk->dir_count)++;
+
+    fd = openat (dir_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+    return (fd != -1) ? do_compute_dir_size_at (fd, walk) : FILE_CONT;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Computes the number of bytes used by the files in a local directory.
+ * Entries are accessed relative to the descriptor of their directory, so paths are neither
+ * built nor resolved by the kernel for every entry. Files with several hard links are
+ * counted once in size.
+ *
+ * If the contents of directory is in the cache of directory sizes, only its subdirectories
+ * are visited.
+ *
+ * @param dir_fd descriptor of directory to scan, is closed by this function
+ * @param walk scan state
+ *
+ * @return FILE_CONT or FILE_ABORT
+ */
+
+static FileProgressStatus
+do_compute_dir_size_at (int dir_fd, dir_size_walk_t * walk)
+{
+    struct stat dir_st;
+    gboolean cacheable;
+    const dir_size_entry_t *cached = NULL;
+    DIR *dir;
+    struct dirent *dirent;
+    gsize len;
+    size_t files = 0;
+    uintmax_t bytes = 0;
+    GPtrArray *subdirs = NULL;
+    FileProgressStatus ret = FILE_CONT;
+
+    len = walk->path->len;
+
+    cacheable = cache_dir_sizes && fstat (dir_fd, &dir_st) == 0;
+    if (cacheable)
+        cached = dir_size_cache_get (&dir_st);
+
+    if (cached != NULL)
+    {
+        guint i;
+
+        *walk->ret_marked += cached->files;
+        *walk->ret_total += cached->bytes;
+
+        for (i = 0; ret == FILE_CONT && i < cached->subdirs->len; i++)
+        {
+            const char *name = (const char *) g_ptr_array_index (cached->subdirs, i);
+
+            dir_size_walk_enter (walk, name);
+            ret = dir_size_walk_subdir (dir_fd, name, walk);
+            if (ret == FILE_CONT)
+                ret = dir_size_walk_progress (walk);
+            g_string_truncate (walk->path, len);
+        }
+
+        close (dir_fd);
+        return ret;
+    }
+
+    dir = fdopendir (dir_fd);
+    if (dir == NULL)
+    {
+        close (dir_fd);
+        return ret;
+    }
+
+    if (cacheable)
+        subdirs = g_ptr_array_new_with_free_func (g_free);
+
+    while (ret == FILE_CONT && (dirent = readdir (dir)) != NULL)
+    {
+        struct stat s;
+
+        if (DIR_IS_DOT (dirent->d_name) || DIR_IS_DOTDOT (dirent->d_name))
+            continue;
+
+        if (fstatat (dirfd (dir), dirent->d_name, &s, AT_SYMLINK_NOFOLLOW) != 0)
+        {
+            cacheable = FALSE;
+            continue;
+        }
+
+        dir_size_walk_enter (walk, dirent->d_name);
+
+        if (S_ISDIR (s.st_mode))
+        {
+            if (subdirs != NULL)
+                g_ptr_array_add (subdirs, g_strdup (dirent->d_name));
+            ret = dir_size_walk_subdir (dirfd (dir), dirent->d_name, walk);
+        }
+        else
+        {
+            (*walk->ret_marked)++;
+            files++;
+
+            if (s.st_nlink < 2)
+            {
+                *walk->ret_total += (uintmax_t) s.st_size;
+                bytes += (uintmax_t) s.st_size;
+            }
+            else
+            {
+                dir_size_inode_t inode = { s.st_dev, s.st_ino };
+
+                /* hard links are deduplicated across the whole tree */
+                cacheable = FALSE;
+
+                if (g_hash_table_lookup (walk->inodes, &inode) == NULL)
+                {
+                    g_hash_table_insert (walk->inodes, g_memdup (&inode, sizeof (inode)),
+                                         GINT_TO_POINTER (1));
+                    *walk->ret_total += (uintmax_t) s.st_size;
+                }
+            }
+        }
+
+        if (ret == FILE_CONT)
+            ret = dir_size_walk_progress (walk);
+
+        g_string_truncate (walk->path, len);
+    }
+
+    closedir (dir);
+
+    if (subdirs != NULL)
+    {
+        if (cacheable && ret == FILE_CONT)
+            dir_size_cache_put (&dir_st, files, bytes, subdirs);
+        else
+            g_ptr_array_free (subdirs, TRUE);
+    }
+
+    return ret;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check whether directory can be scanned by do_compute_dir_size_at().
+ *
+ * @return path of directory in local file system or NULL
+ */
+
+static const char *
+dir_size_local_path (const vfs_path_t * vpath)
+{
+    if (vfs_path_elements_count (vpath) != 1 || !vfs_file_is_local (vpath))
+        return NULL;
+
+#ifdef HAVE_CHARSET
+    if (vfs_path_get_by_index (vpath, -1)->encoding != NULL)
+        return NULL;
+#endif
+
+    return vfs_path_get_last_path_str (vpath);
+}
+#endif /* HAVE_FSTATAT && HAVE_FDOPENDIR */
+
 /* --------------------------------------------------------------------------------------------- */
 /**
  * do_compute_dir_size:
@@ -520,11 +821,6 @@ do_compute_dir_size (const vfs_path_t * dirname_vpath, dirsize_status_msg_t * ds
                      size_t * dir_count, size_t * ret_marked, uintmax_t * ret_total,
                      gboolean compute_symlinks)
 {
-    static guint64 timestamp = 0;
-    /* update with 25 FPS rate */
-    static const guint64 delay = G_USEC_PER_SEC / 25;
-
-    status_msg_t *sm = STATUS_MSG (dsm);
     int res;
     struct stat s;
     DIR *dir;
@@ -548,6 +844,37 @@ do_compute_dir_size (const vfs_path_t * dirname_vpath, dirsize_status_msg_t * ds
 
     (*dir_count)++;
 
+#if defined(HAVE_FSTATAT) && defined(HAVE_FDOPENDIR)
+    {
+        const char *path;
+
+        path = dir_size_local_path (dirname_vpath);
+        if (path != NULL)
+        {
+            dir_size_walk_t walk;
+            int fd;
+
+            fd = open (path, O_RDONLY | O_DIRECTORY);
+            if (fd == -1)
+                return ret;
+
+            walk.dsm = dsm;
+            walk.dir_count = dir_count;
+            walk.ret_marked = ret_marked;
+            walk.ret_total = ret_total;
+            walk.path = g_string_new (path);
+            walk.inodes =
+                g_hash_table_new_full (dir_size_inode_hash, dir_size_inode_equal, g_free, NULL);
+
+            ret = do_compute_dir_size_at (fd, &walk);
+
+            g_hash_table_destroy (walk.inodes);
+            g_string_free (walk.path, TRUE);
+            return ret;
+        }
+    }
+#endif /* HAVE_FSTATAT && HAVE_FDOPENDIR */
+
     dir = mc_opendir (dirname_vpath);
     if (dir == NULL)
         return ret;
@@ -576,13 +903,8 @@ do_compute_dir_size (const vfs_path_t * dirname_vpath, dirsize_status_msg_t * ds
                 *ret_total += (uintmax_t) s.st_size;
             }
 
-            if (ret == FILE_CONT && sm->update != NULL && mc_time_elapsed (&timestamp, delay))
-            {
-                dsm->dirname_vpath = tmp_vpath;
-                dsm->dir_count = *dir_count;
-                dsm->total_size = *ret_total;
-                ret = sm->update (sm);
-            }
+            if (ret == FILE_CONT)
+                ret = dir_size_update_progress (dsm, tmp_vpath, *dir_count, *ret_total);
         }
 
         vfs_path_free (tmp_vpath);
@@ -603,6 +925,11 @@ progress_update_one (file_op_total_context_t * tctx, file_op_context_t * ctx, of
     tctx->progress_count++;
     tctx->progress_bytes += (uintmax_t) add;
 
+#ifdef ENABLE_BACKGROUND
+    if (mc_global.we_are_background)
+        background_progress_update (tctx->progress_count, tctx->progress_bytes, NULL);
+#endif
+
     if (tv_start.tv_sec == 0)
     {
         gettimeofday (&tv_start, (struct timezone *) NULL);
@@ -853,6 +1180,263 @@ files_error (const char *format, const char *file1, const char *file2)
 
 /* }}} */
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Read the target file back and compare its checksum with the checksum of copied data.
+ * Cached pages of local file are dropped before, so the data is really read from the disk.
+ *
+ * @param tctx total context of operation
+ * @param ctx context of operation
+ * @param dst_path target file name
+ * @param dst_vpath target file
+ * @param offset offset of copied data in the target file
+ * @param file_size size of target file
+ * @param expected checksum of copied data
+ *
+ * @return FILE_CONT if the target file is verified, status of error dialog otherwise
+ */
+
+static FileProgressStatus
+copy_file_verify (file_op_total_context_t * tctx, file_op_context_t * ctx, const char *dst_path,
+                  const vfs_path_t * dst_vpath, off_t offset, off_t file_size,
+                  const char *expected)
+{
+    FileProgressStatus return_status;
+
+    while (TRUE)
+    {
+        int fd;
+        gboolean verified = FALSE;
+
+        fd = mc_open (dst_vpath, O_RDONLY | O_LINEAR);
+        if (fd >= 0)
+        {
+            if (offset == 0 || mc_lseek (fd, offset, SEEK_SET) == offset)
+            {
+                GChecksum *dst_sum;
+                char buf[BUF_8K];
+                ssize_t n_read;
+                off_t n_read_total = offset;
+
+                (void) vfs_drop_cache (fd, 0, 0, TRUE);
+
+                dst_sum = g_checksum_new (G_CHECKSUM_MD5);
+
+                while ((n_read = mc_read (fd, buf, sizeof (buf))) > 0)
+                {
+                    g_checksum_update (dst_sum, (const guchar *) buf, n_read);
+                    n_read_total += n_read;
+
+                    if (tty_refresh_delay () == 0)
+                    {
+                        file_progress_show (ctx, n_read_total, file_size, _("(verifying)"),
+                                            FALSE);
+                        mc_refresh ();
+                    }
+
+                    if (check_progress_buttons (ctx) == FILE_ABORT)
+                    {
+                        g_checksum_free (dst_sum);
+                        mc_close (fd);
+                        return FILE_ABORT;
+                    }
+                }
+
+                if (n_read == 0)
+                {
+                    verified = (strcmp (g_checksum_get_string (dst_sum), expected) == 0);
+                    if (!verified)
+                        errno = EIO;
+                }
+
+                g_checksum_free (dst_sum);
+            }
+
+            mc_close (fd);
+        }
+
+        if (verified)
+        {
+            tctx->verify_ok_count++;
+            return FILE_CONT;
+        }
+
+        if (ctx->skip_all)
+            return_status = FILE_SKIPALL;
+        else
+        {
+            return_status = file_error (_("Cannot verify target file \"%s\"\n%s"), dst_path);
+            if (return_status == FILE_SKIPALL)
+                ctx->skip_all = TRUE;
+        }
+
+        if (return_status != FILE_RETRY)
+            break;
+    }
+
+    tctx->verify_failed_count++;
+    return return_status;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Keep speed of copying under the limit using a token bucket. Tokens come at the rate
+ * of limit, no more than for one second are stored, and every copied byte takes one of them.
+ * If the bucket is in debt, sleep a bit.
+ *
+ * @param tctx file operation total context object
+ * @param ctx file operation context object
+ *
+ * @return TRUE if the speed is still over the limit and no data should be copied now,
+ *         FALSE otherwise
+ */
+
+static gboolean
+copy_file_throttle (file_op_total_context_t * tctx, const file_op_context_t * ctx)
+{
+    struct timeval tv;
+    guint64 now, elapsed;
+    gint64 limit;
+
+    if (ctx->bw_limit == 0)
+    {
+        tctx->throttle_time = 0;
+        tctx->throttle_tokens = 0;
+        return FALSE;
+    }
+
+    limit = (gint64) MIN (ctx->bw_limit, (uintmax_t) (G_MAXINT64 / G_USEC_PER_SEC));
+
+    gettimeofday (&tv, NULL);
+    now = (guint64) tv.tv_sec * G_USEC_PER_SEC + tv.tv_usec;
+
+    if (tctx->throttle_time != 0 && now > tctx->throttle_time)
+    {
+        elapsed = MIN (now - tctx->throttle_time, G_USEC_PER_SEC);
+        tctx->throttle_tokens += (gint64) elapsed * limit / G_USEC_PER_SEC;
+        tctx->throttle_tokens = MIN (tctx->throttle_tokens, limit);
+    }
+    tctx->throttle_time = now;
+
+    if (tctx->throttle_tokens >= 0)
+        return FALSE;
+
+    g_usleep (MIN ((gulong) (-tctx->throttle_tokens * G_USEC_PER_SEC / limit),
+                   COPY_THROTTLE_SLICE));
+    return TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Drop recently copied data of file from the page cache. Dirty pages written after
+ * previous call are not dropped yet, so the range covers two steps.
+ *
+ * @param fd mc VFS file handler
+ */
+
+static void
+copy_file_drop_cache (int fd)
+{
+    off_t pos, start;
+
+    pos = mc_lseek (fd, 0, SEEK_CUR);
+    if (pos <= 0)
+        return;
+
+    start = MAX (pos - 2 * COPY_DROP_CACHE_STEP, 0);
+    (void) vfs_drop_cache (fd, start, pos - start, FALSE);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static gboolean
+copy_file_use_journal (const struct stat *src_st, const vfs_path_t * dst_vpath)
+{
+    return (S_ISREG (src_st->st_mode) && src_st->st_size >= COPY_JOURNAL_MIN_SIZE
+            && vfs_file_is_local (dst_vpath));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Find how much of the target file left by interrupted copy is valid: compare its blocks
+ * with the checksums recorded in the journal.
+ *
+ * @param ctx context of operation
+ * @param journal journal of interrupted copy
+ * @param dst_vpath target file
+ * @param dst_size size of target file
+ * @param file_size size of source file
+ * @param valid_blocks where to store number of valid blocks
+ *
+ * @return FILE_CONT or FILE_ABORT if user aborted the check
+ */
+
+static FileProgressStatus
+copy_file_resume_blocks (file_op_context_t * ctx, const copy_journal_t * journal,
+                         const vfs_path_t * dst_vpath, off_t dst_size, off_t file_size,
+                         guint * valid_blocks)
+{
+    guint blocks, i;
+    int fd;
+    FileProgressStatus ret = FILE_CONT;
+
+    *valid_blocks = 0;
+
+    blocks = MIN (copy_journal_get_blocks (journal), (guint) (dst_size / COPY_JOURNAL_BLOCK_SIZE));
+    if (blocks == 0)
+        return FILE_CONT;
+
+    fd = mc_open (dst_vpath, O_RDONLY | O_LINEAR);
+    if (fd < 0)
+        return FILE_CONT;
+
+    for (i = 0; i < blocks; i++)
+    {
+        GChecksum *sum;
+        char buf[BUF_8K];
+        off_t left = COPY_JOURNAL_BLOCK_SIZE;
+        gboolean valid;
+
+        sum = g_checksum_new (G_CHECKSUM_MD5);
+
+        while (left != 0)
+        {
+            ssize_t n_read;
+
+            n_read = mc_read (fd, buf, (size_t) MIN ((off_t) sizeof (buf), left));
+            if (n_read <= 0)
+                break;
+
+            g_checksum_update (sum, (const guchar *) buf, n_read);
+            left -= n_read;
+        }
+
+        valid = (left == 0
+                 && strcmp (g_checksum_get_string (sum), copy_journal_get_block (journal, i)) == 0);
+        g_checksum_free (sum);
+
+        if (!valid)
+            break;
+
+        if (tty_refresh_delay () == 0)
+        {
+            file_progress_show (ctx, (off_t) (i + 1) * COPY_JOURNAL_BLOCK_SIZE, file_size,
+                                _("(checking)"), FALSE);
+            mc_refresh ();
+        }
+
+        ret = check_progress_buttons (ctx);
+        if (ret == FILE_ABORT)
+            break;
+        ret = FILE_CONT;
+    }
+
+    mc_close (fd);
+
+    *valid_blocks = i;
+    return ret;
+}
+
 /* --------------------------------------------------------------------------------------------- */
 
 static void
@@ -968,6 +1552,7 @@ move_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx, const c
 
         if (confirm_overwrite)
         {
+            ctx->do_reget = 0;
             return_status = query_replace (ctx, d, &src_stats, &dst_stats);
             if (return_status != FILE_CONT)
                 goto ret;
@@ -1469,6 +2054,59 @@ end_bg_process (file_op_context_t * ctx, enum OperationMode mode)
     /*     file_op_context_destroy(ctx); */
     return 1;
 }
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get device the operation works on: the destination or the source. If the destination
+ * doesn't exist yet, it is created on the device of its nearest existing parent.
+ */
+
+static dev_t
+panel_operate_device (const WPanel * panel, const vfs_path_t * dest_vpath)
+{
+    struct stat st;
+
+    if (dest_vpath != NULL)
+    {
+        char *path;
+
+        path = g_strdup (vfs_path_as_str (dest_vpath));
+
+        while (TRUE)
+        {
+            vfs_path_t *vpath;
+            char *parent;
+            gboolean ok;
+
+            vpath = vfs_path_from_str (path);
+            ok = mc_stat (vpath, &st) == 0;
+            vfs_path_free (vpath);
+
+            if (ok)
+            {
+                g_free (path);
+                return st.st_dev;
+            }
+
+            parent = g_path_get_dirname (path);
+            if (strcmp (parent, path) == 0)
+            {
+                g_free (parent);
+                break;
+            }
+
+            g_free (path);
+            path = parent;
+        }
+
+        g_free (path);
+    }
+
+    if (mc_stat (panel->cwd_vpath, &st) == 0)
+        return st.st_dev;
+
+    return 0;
+}
 #endif
 /* }}} */
 
@@ -1496,6 +2134,9 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
     int open_flags;
     gboolean is_first_time = TRUE;
     vfs_path_t *src_vpath = NULL, *dst_vpath = NULL;
+    GChecksum *src_sum = NULL;
+    copy_journal_t *journal = NULL;
+    off_t resume_offset = 0;
 
     /* FIXME: We should not be using global variables! */
     ctx->do_reget = 0;
@@ -1561,16 +2202,49 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
             goto ret_fast;
         }
 
-        /* Should we replace destination? */
+        /* target left by interrupted copy can be resumed */
+        if (copy_file_use_journal (&sb, dst_vpath))
+        {
+            guint blocks;
+
+            journal = copy_journal_new (src_path, dst_path, &sb);
+            temp_status = copy_file_resume_blocks (ctx, journal, dst_vpath, sb2.st_size,
+                                                   sb.st_size, &blocks);
+            if (temp_status != FILE_CONT)
+            {
+                /* the journal is kept to resume the copy later */
+                return_status = temp_status;
+                goto ret_fast;
+            }
+
+            resume_offset = (off_t) blocks * COPY_JOURNAL_BLOCK_SIZE;
+        }
+
+        /* Should we replace destination? Resuming the copy is offered as an answer and is
+           done without asking only if the previous answer permits to overwrite targets */
         if (tctx->ask_overwrite)
         {
-            ctx->do_reget = 0;
+            ctx->do_reget = resume_offset;
             return_status = query_replace (ctx, dst_path, &sb, &sb2);
             if (return_status != FILE_CONT)
                 goto ret_fast;
+
+            /* target is overwritten or appended to instead */
+            if (ctx->do_append || ctx->do_reget != resume_offset)
+                resume_offset = 0;
+        }
+
+        /* the journal doesn't describe data appended to the target */
+        if (ctx->do_append)
+        {
+            copy_journal_free (journal, TRUE);
+            journal = NULL;
         }
     }
 
+    if (resume_offset != 0)
+        ctx->do_reget = resume_offset;
+
     if (!ctx->do_append)
     {
         /* Check the hardlinks */
@@ -1659,6 +2333,7 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
             message (D_ERROR, _("Warning"), _("Reget failed, about to overwrite file"));
             ctx->do_reget = 0;
             ctx->do_append = FALSE;
+            resume_offset = 0;
         }
     }
 
@@ -1685,12 +2360,16 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
     utb.modtime = sb.st_mtime;
     file_size = sb.st_size;
 
+    if (journal == NULL && !ctx->do_append && copy_file_use_journal (&sb, dst_vpath))
+        journal = copy_journal_new (src_path, dst_path, &sb);
+
     open_flags = O_WRONLY;
     if (dst_exists)
     {
         if (ctx->do_append != 0)
             open_flags |= O_APPEND;
-        else
+        /* resumed target is rewritten in place after its valid blocks */
+        else if (resume_offset == 0)
             open_flags |= O_CREAT | O_TRUNC;
     }
     else
@@ -1718,6 +2397,46 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
     }
     dst_status = DEST_SHORT;    /* file opened, but not fully copied */
 
+    /* unchecked rest of resumed target is dropped, so the complete target is not longer
+       than the source. Journal is used only for local targets */
+    while (resume_offset != 0
+           && truncate (vfs_path_get_last_path_str (dst_vpath), resume_offset) != 0)
+    {
+        if (ctx->skip_all)
+            return_status = FILE_SKIPALL;
+        else
+        {
+            return_status = file_error (_("Cannot truncate target file \"%s\"\n%s"), dst_path);
+            if (return_status == FILE_RETRY)
+                continue;
+            if (return_status == FILE_SKIPALL)
+                ctx->skip_all = TRUE;
+        }
+        goto ret;
+    }
+
+    while (resume_offset != 0 && mc_lseek (dest_desc, resume_offset, SEEK_SET) != resume_offset)
+    {
+        if (ctx->skip_all)
+            return_status = FILE_SKIPALL;
+        else
+        {
+            return_status = file_error (_("Cannot seek target file \"%s\"\n%s"), dst_path);
+            if (return_status == FILE_RETRY)
+                continue;
+            if (return_status == FILE_SKIPALL)
+                ctx->skip_all = TRUE;
+        }
+        goto ret;
+    }
+
+    if (journal != NULL && !copy_journal_start (journal, resume_offset / COPY_JOURNAL_BLOCK_SIZE))
+    {
+        /* copy without journal */
+        copy_journal_free (journal, FALSE);
+        journal = NULL;
+    }
+
     appending = ctx->do_append;
     ctx->do_append = FALSE;
 
@@ -1785,11 +2504,16 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
     if (return_status != FILE_CONT)
         goto ret;
 
+    /* the data appended without reget doesn't start at the same offset in both files */
+    if (ctx->verify && (!appending || ctx->do_reget != 0))
+        src_sum = g_checksum_new (G_CHECKSUM_MD5);
+
     {
         off_t n_read_total = 0;
         struct timeval tv_current, tv_last_update, tv_last_input;
         int secs, update_secs;
         const char *stalled_msg = "";
+        off_t cache_dropped = 0;
 
         tv_last_update = tv_transfer_start;
 
@@ -1797,6 +2521,15 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
         {
             char buf[BUF_8K];
 
+            /* wait while the speed is over the limit, but keep the progress buttons alive */
+            if (copy_file_throttle (tctx, ctx))
+            {
+                return_status = check_progress_buttons (ctx);
+                if (return_status != FILE_CONT)
+                    goto ret;
+                continue;
+            }
+
             /* src_read */
             if (mc_ctl (src_desc, VFS_CTL_IS_NOTREADY, 0))
                 n_read = -1;
@@ -1820,6 +2553,13 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
                 char *t = buf;
                 n_read_total += n_read;
 
+                if (src_sum != NULL)
+                    g_checksum_update (src_sum, (const guchar *) buf, n_read);
+                if (journal != NULL)
+                    copy_journal_update (journal, buf, n_read);
+                if (ctx->bw_limit != 0)
+                    tctx->throttle_tokens -= n_read;
+
                 /* Windows NT ftp servers report that files have no
                  * permissions: -------, so if we happen to have actually
                  * read something, we should fix the permissions.
@@ -1867,6 +2607,18 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
 
             tctx->copied_bytes = tctx->progress_bytes + n_read_total + ctx->do_reget;
 
+            if (ctx->drop_cache && n_read_total - cache_dropped >= COPY_DROP_CACHE_STEP)
+            {
+                copy_file_drop_cache (src_desc);
+                copy_file_drop_cache (dest_desc);
+                cache_dropped = n_read_total;
+            }
+
+#ifdef ENABLE_BACKGROUND
+            if (mc_global.we_are_background)
+                background_progress_update (tctx->progress_count, tctx->copied_bytes, src_path);
+#endif
+
             secs = (tv_current.tv_sec - tv_last_update.tv_sec);
             update_secs = (tv_current.tv_sec - tv_last_input.tv_sec);
 
@@ -1884,6 +2636,8 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
                 stalled_msg = _("(stalled)");
             }
 
+            /* don't update progress which would not be shown */
+            if (tty_refresh_delay () == 0)
             {
                 gboolean force_update;
 
@@ -1899,7 +2653,7 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
                 file_progress_show (ctx, n_read_total + ctx->do_reget, file_size, stalled_msg,
                                     force_update);
             }
-            mc_refresh ();
+            mc_refresh_frame ();
 
             return_status = check_progress_buttons (ctx);
 
@@ -1915,6 +2669,16 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
 
   ret:
     rotate_dash (FALSE);
+
+    if (ctx->drop_cache)
+    {
+        /* complete target is written out first, otherwise its dirty pages are kept */
+        if (src_desc != -1)
+            (void) vfs_drop_cache (src_desc, 0, 0, FALSE);
+        if (dest_desc != -1)
+            (void) vfs_drop_cache (dest_desc, 0, 0, dst_status == DEST_FULL);
+    }
+
     while (src_desc != -1 && mc_close (src_desc) < 0 && !ctx->skip_all)
     {
         temp_status = file_error (_("Cannot close source file \"%s\"\n%s"), src_path);
@@ -1938,12 +2702,20 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
         break;
     }
 
+    if (dst_status == DEST_FULL && src_sum != NULL && return_status == FILE_CONT)
+        return_status = copy_file_verify (tctx, ctx, dst_path, dst_vpath, ctx->do_reget, file_size,
+                                          g_checksum_get_string (src_sum));
+
     if (dst_status == DEST_SHORT)
     {
         /* Query to remove short file */
         if (query_dialog (Q_ ("DialogTitle|Copy"), _("Incomplete file was retrieved. Keep it?"),
                           D_ERROR, 2, _("&Delete"), _("&Keep")) == 0)
+        {
             mc_unlink (dst_vpath);
+            copy_journal_free (journal, TRUE);
+            journal = NULL;
+        }
     }
     else if (dst_status == DEST_FULL)
     {
@@ -2000,6 +2772,10 @@ copy_file_file (file_op_total_context_t * tctx, file_op_context_t * ctx,
         return_status = progress_update_one (tctx, ctx, file_size);
 
   ret_fast:
+    /* the journal of incomplete copy is kept to resume it later */
+    copy_journal_free (journal, dst_status == DEST_FULL);
+    if (src_sum != NULL)
+        g_checksum_free (src_sum);
     vfs_path_free (src_vpath);
     vfs_path_free (dst_vpath);
     return return_status;
@@ -2612,6 +3388,7 @@ panel_operate (void *source_panel, FileOperation operation, gboolean force_singl
     file_op_total_context_t *tctx;
     vfs_path_t *tmp_vpath;
     filegui_dialog_type_t dialog_type = FILEGUI_DIALOG_ONE_ITEM;
+    int saved_ioprio = -1;
 
     gboolean do_bg = FALSE;     /* do background operation? */
 
@@ -2766,7 +3543,8 @@ panel_operate (void *source_panel, FileOperation operation, gboolean force_singl
 
         v = do_background (ctx,
                            g_strconcat (op_names[operation], ": ",
-                                        vfs_path_as_str (panel->cwd_vpath), (char *) NULL));
+                                        vfs_path_as_str (panel->cwd_vpath), (char *) NULL),
+                           panel_operate_device (panel, dest_vpath));
         if (v == -1)
             message (D_ERROR, MSG_ERROR, _("Sorry, I could not put the job in background"));
 
@@ -2793,6 +3571,15 @@ panel_operate (void *source_panel, FileOperation operation, gboolean force_singl
             dialog_type = FILEGUI_DIALOG_ONE_ITEM;
         else
             dialog_type = FILEGUI_DIALOG_MULTI_ITEM;
+
+        /* background job gets the idle class as its priority, see do_background() */
+        if (ctx->idle_io)
+        {
+            saved_ioprio = mc_ioprio_get (0);
+            if (saved_ioprio >= 0
+                && mc_ioprio_set (0, MC_IOPRIO_VALUE (MC_IOPRIO_CLASS_IDLE, 0)) != 0)
+                saved_ioprio = -1;
+        }
     }
 
     /* Initialize things */
@@ -3025,19 +3812,24 @@ panel_operate (void *source_panel, FileOperation operation, gboolean force_singl
                 if (value == FILE_CONT)
                     do_file_mark (panel, i, 0);
 
-                if (verbose && ctx->dialog_type == FILEGUI_DIALOG_MULTI_ITEM)
+                /* don't update progress which would not be shown */
+                if (tty_refresh_delay () == 0)
                 {
-                    file_progress_show_count (ctx, tctx->progress_count, ctx->progress_count);
-                    file_progress_show_total (tctx, ctx, tctx->progress_bytes, FALSE);
-                }
+                    if (verbose && ctx->dialog_type == FILEGUI_DIALOG_MULTI_ITEM)
+                    {
+                        file_progress_show_count (ctx, tctx->progress_count,
+                                                  ctx->progress_count);
+                        file_progress_show_total (tctx, ctx, tctx->progress_bytes, FALSE);
+                    }
 
-                if (operation != OP_DELETE)
-                    file_progress_show (ctx, 0, 0, "", FALSE);
+                    if (operation != OP_DELETE)
+                        file_progress_show (ctx, 0, 0, "", FALSE);
+                }
 
                 if (check_progress_buttons (ctx) == FILE_ABORT)
                     break;
 
-                mc_refresh ();
+                mc_refresh_frame ();
             }                   /* Loop for every file */
         }
     }                           /* Many entries */
@@ -3069,6 +3861,14 @@ panel_operate (void *source_panel, FileOperation operation, gboolean force_singl
     vfs_path_free (dest_vpath);
     MC_PTR_FREE (ctx->dest_mask);
 
+    if (saved_ioprio >= 0)
+        (void) mc_ioprio_set (0, saved_ioprio);
+
+    if (ctx->verify && (tctx->verify_ok_count != 0 || tctx->verify_failed_count != 0))
+        message (tctx->verify_failed_count != 0 ? D_ERROR : D_NORMAL, _("Verification"),
+                 _("Verified files: %zu\nFailed: %zu"), tctx->verify_ok_count,
+                 tctx->verify_failed_count);
+
 #ifdef ENABLE_BACKGROUND
     /* Let our parent know we are saying bye bye */
     if (mc_global.we_are_background)
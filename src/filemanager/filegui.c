@@ -63,6 +63,7 @@
 #include <errno.h>
 #include <ctype.h>
 #include <stdio.h>
+#include <stdlib.h>             /* atoi() */
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -203,7 +204,8 @@ typedef enum
     REPLACE_NEVER,
     REPLACE_ABORT,
     REPLACE_SIZE,
-    REPLACE_REGET
+    REPLACE_REGET,
+    REPLACE_RESUME
 } replace_action_t;
 
 /* This structure describes the UI and internal data required by a file
@@ -442,16 +444,18 @@ overwrite_query_dialog (file_op_context_t * ctx, enum OperationMode mode)
         /*  8 */
         { N_("&Reget"), 10, 28, WPOS_KEEP_DEFAULT, REPLACE_REGET },
         /*  9 */
-        { N_("Overwrite all targets?"), 11, 4, WPOS_KEEP_DEFAULT, 0 },
+        { N_("Resu&me"), 10, 28, WPOS_KEEP_DEFAULT, REPLACE_RESUME },
         /* 10 */
-        { N_("A&ll"), 11, 28, WPOS_KEEP_DEFAULT, REPLACE_ALWAYS },
+        { N_("Overwrite all targets?"), 11, 4, WPOS_KEEP_DEFAULT, 0 },
         /* 11 */
-        { N_("&Update"), 11, 36, WPOS_KEEP_DEFAULT, REPLACE_UPDATE },
+        { N_("A&ll"), 11, 28, WPOS_KEEP_DEFAULT, REPLACE_ALWAYS },
         /* 12 */
-        { N_("Non&e"), 11, 47, WPOS_KEEP_DEFAULT, REPLACE_NEVER },
+        { N_("&Update"), 11, 36, WPOS_KEEP_DEFAULT, REPLACE_UPDATE },
         /* 13 */
-        { N_("If &size differs"), 12, 28, WPOS_KEEP_DEFAULT, REPLACE_SIZE },
+        { N_("Non&e"), 11, 47, WPOS_KEEP_DEFAULT, REPLACE_NEVER },
         /* 14 */
+        { N_("If &size differs"), 12, 28, WPOS_KEEP_DEFAULT, REPLACE_SIZE },
+        /* 15 */
         { N_("&Abort"), 14, 25, WPOS_KEEP_TOP | WPOS_CENTER_HORZ, REPLACE_ABORT }
     /* *INDENT-ON* */
     };
@@ -500,7 +504,7 @@ overwrite_query_dialog (file_op_context_t * ctx, enum OperationMode mode)
          * longest of "Overwrite..." labels
          * (assume "Target date..." are short enough)
          */
-        l1 = max (widgets_len[9], widgets_len[4]);
+        l1 = max (widgets_len[10], widgets_len[4]);
 
         /* longest of button rows */
         l = l2 = 0;
@@ -538,6 +542,9 @@ overwrite_query_dialog (file_op_context_t * ctx, enum OperationMode mode)
                 rd_widgets[i].xpos = l;
                 l += widgets_len[i] + 4;
             }
+
+        /* Reget and Resume are never shown together */
+        rd_widgets[9].xpos = rd_widgets[8].xpos;
     }
 
     /* FIXME - missing help node */
@@ -575,22 +582,25 @@ overwrite_query_dialog (file_op_context_t * ctx, enum OperationMode mode)
     {
         ADD_RD_BUTTON (7, y++); /* Append */
 
-        if ((ctx->operation == OP_COPY) && (ui->d_stat->st_size != 0)
-            && (ui->s_stat->st_size > ui->d_stat->st_size))
+        /* copy interrupted before can be resumed from ctx->do_reget */
+        if (ctx->do_reget != 0)
+            yes_id = ADD_RD_BUTTON (9, y++);    /* Resume */
+        else if ((ctx->operation == OP_COPY) && (ui->d_stat->st_size != 0)
+                 && (ui->s_stat->st_size > ui->d_stat->st_size))
             ADD_RD_BUTTON (8, y++);     /* Reget */
     }
 
     add_widget (ui->replace_dlg, hline_new (y++, -1, -1));
 
-    ADD_RD_LABEL (9, 0, 0, y);  /* Overwrite all targets? */
-    ADD_RD_BUTTON (10, y);      /* All" */
-    ADD_RD_BUTTON (11, y);      /* Update */
-    ADD_RD_BUTTON (12, y++);    /* None */
-    ADD_RD_BUTTON (13, y++);    /* If size differs */
+    ADD_RD_LABEL (10, 0, 0, y); /* Overwrite all targets? */
+    ADD_RD_BUTTON (11, y);      /* All" */
+    ADD_RD_BUTTON (12, y);      /* Update */
+    ADD_RD_BUTTON (13, y++);    /* None */
+    ADD_RD_BUTTON (14, y++);    /* If size differs */
 
     add_widget (ui->replace_dlg, hline_new (y++, -1, -1));
 
-    ADD_RD_BUTTON (14, y);      /* Abort */
+    ADD_RD_BUTTON (15, y);      /* Abort */
 
     label_set_text (LABEL (label1), str_trunc (stripped_name, rd_xlen - 8));
     dlg_set_size (ui->replace_dlg, y + 3, rd_xlen);
@@ -650,6 +660,36 @@ place_progress_buttons (WDialog * h, gboolean suspended)
 
 /* --------------------------------------------------------------------------------------------- */
 
+/**
+ * Change speed limit of running operation by key.
+ *
+ * @param ctx file operation context
+ * @param key '-' to halve the limit, '+' to double it, '*' to remove it
+ */
+
+static void
+progress_change_speed_limit (file_op_context_t * ctx, int key)
+{
+    switch (key)
+    {
+    case '-':
+        /* unlimited operation is slowed down from its current speed */
+        if (ctx->bw_limit == 0)
+            ctx->bw_limit = ctx->bps > 0 ? (uintmax_t) ctx->bps : 2048;
+        ctx->bw_limit = max (ctx->bw_limit / 2, 1024);
+        break;
+    case '+':
+        if (ctx->bw_limit != 0)
+            ctx->bw_limit *= 2;
+        break;
+    default:
+        ctx->bw_limit = 0;
+        break;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
 static int
 progress_button_callback (WButton * button, int action)
 {
@@ -682,6 +722,14 @@ check_progress_buttons (file_op_context_t * ctx)
     if (c == EV_NONE)
         return FILE_CONT;
 
+    if (c == '+' || c == '-' || c == '*')
+    {
+        progress_change_speed_limit (ctx, c);
+        if (ctx->suspended)
+            goto get_event;
+        return FILE_CONT;
+    }
+
     /* Reinitialize to avoid old values after events other than selecting a button */
     ui->op_dlg->ret_value = FILE_CONT;
 
@@ -884,7 +932,7 @@ file_progress_show (file_op_context_t * ctx, off_t done, off_t total,
                     const char *stalled_msg, gboolean force_update)
 {
     file_op_context_ui_t *ui;
-    char buffer[BUF_TINY];
+    char buffer[BUF_SMALL];
 
     if (!verbose || ctx == NULL || ctx->ui == NULL)
         return;
@@ -909,18 +957,28 @@ file_progress_show (file_op_context_t * ctx, off_t done, off_t total,
 
         file_eta_prepare_for_show (buffer2, ctx->eta_secs, FALSE);
         if (ctx->bps == 0)
-            g_snprintf (buffer, BUF_TINY, "%s %s", buffer2, stalled_msg);
+            g_snprintf (buffer, sizeof (buffer), "%s %s", buffer2, stalled_msg);
         else
         {
             char buffer3[BUF_TINY];
 
             file_bps_prepare_for_show (buffer3, ctx->bps);
-            g_snprintf (buffer, BUF_TINY, "%s (%s) %s", buffer2, buffer3, stalled_msg);
+            g_snprintf (buffer, sizeof (buffer), "%s (%s) %s", buffer2, buffer3, stalled_msg);
         }
     }
     else
     {
-        g_snprintf (buffer, BUF_TINY, "%s", stalled_msg);
+        g_snprintf (buffer, sizeof (buffer), "%s", stalled_msg);
+    }
+
+    if (ctx->bw_limit != 0)
+    {
+        char buffer2[BUF_TINY];
+        size_t len;
+
+        file_bps_prepare_for_show (buffer2, (long) min (ctx->bw_limit, (uintmax_t) G_MAXLONG));
+        len = strlen (buffer);
+        g_snprintf (buffer + len, sizeof (buffer) - len, _(" [limit %s]"), buffer2);
     }
 
     label_set_text (ui->progress_file_label, buffer);
@@ -1143,13 +1201,25 @@ file_progress_real_query_replace (file_op_context_t * ctx,
             return FILE_CONT;
 
     case REPLACE_REGET:
-        /* Careful: we fall through and set do_append */
         ctx->do_reget = _d_stat->st_size;
+        ctx->do_append = TRUE;
+        do_refresh ();
+        return FILE_CONT;
 
     case REPLACE_APPEND:
+        ctx->do_reget = 0;
         ctx->do_append = TRUE;
+        do_refresh ();
+        return FILE_CONT;
 
     case REPLACE_YES:
+        /* target is overwritten instead of resuming the copy */
+        ctx->do_reget = 0;
+        do_refresh ();
+        return FILE_CONT;
+
+    case REPLACE_RESUME:
+        /* copy is resumed from ctx->do_reget */
     case REPLACE_ALWAYS:
         do_refresh ();
         return FILE_CONT;
@@ -1226,7 +1296,8 @@ file_mask_dialog (file_op_context_t * ctx, FileOperation operation,
     }
 
     {
-        char *source_mask, *orig_mask;
+        char *source_mask, *orig_mask, *speed_limit;
+        char speed_buf[BUF_TINY];
         int val;
         struct stat buf;
 
@@ -1246,10 +1317,20 @@ file_mask_dialog (file_op_context_t * ctx, FileOperation operation,
             QUICK_START_COLUMNS,
                 QUICK_CHECKBOX (N_("Follow &links"), &ctx->follow_links, NULL),
                 QUICK_CHECKBOX (N_("Preserve &attributes"), &ctx->op_preserve, NULL),
+                QUICK_CHECKBOX (N_("Ve&rify copied files"), &ctx->verify, NULL),
             QUICK_NEXT_COLUMN,
                 QUICK_CHECKBOX (N_("Di&ve into subdir if exists"), &ctx->dive_into_subdirs, NULL),
                 QUICK_CHECKBOX (N_("&Stable symlinks"), &ctx->stable_symlinks, NULL),
             QUICK_STOP_COLUMNS,
+            QUICK_SEPARATOR (TRUE),
+            QUICK_START_COLUMNS,
+                QUICK_CHECKBOX (N_("&Idle I/O priority"), &ctx->idle_io, NULL),
+            QUICK_NEXT_COLUMN,
+                QUICK_CHECKBOX (N_("Don't &keep in cache"), &ctx->drop_cache, NULL),
+            QUICK_STOP_COLUMNS,
+            QUICK_LABELED_INPUT (N_("Speed limit, KiB/s (0 - no limit):"), input_label_left,
+                                 speed_buf, "input-speed", &speed_limit, NULL, FALSE, FALSE,
+                                 INPUT_COMPLETE_NONE),
             QUICK_START_BUTTONS (TRUE, TRUE),
                 QUICK_BUTTON (N_("&OK"), B_ENTER, NULL, NULL),
 #ifdef ENABLE_BACKGROUND
@@ -1266,6 +1347,8 @@ file_mask_dialog (file_op_context_t * ctx, FileOperation operation,
             quick_widgets, NULL, NULL
         };
 
+        g_snprintf (speed_buf, sizeof (speed_buf), "%d", copy_speed_limit);
+
       ask_file_mask:
         val = quick_dialog_skip (&qdlg, 4);
 
@@ -1275,6 +1358,12 @@ file_mask_dialog (file_op_context_t * ctx, FileOperation operation,
             return NULL;
         }
 
+        /* cppcheck-suppress uninitvar */
+        copy_speed_limit = max (atoi (speed_limit), 0);
+        g_free (speed_limit);
+        g_snprintf (speed_buf, sizeof (speed_buf), "%d", copy_speed_limit);
+        ctx->bw_limit = (uintmax_t) copy_speed_limit * 1024;
+
         if (ctx->follow_links)
             ctx->stat_func = mc_stat;
         else
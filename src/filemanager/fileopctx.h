@@ -118,6 +118,19 @@ typedef struct
     /* Whether to recompute symlinks */
     gboolean stable_symlinks;
 
+    /* Whether to read copied files back and compare their checksums */
+    gboolean verify;
+
+    /* Speed limit of copying in bytes per second, 0 means no limit.
+     * Can be changed while the operation is running */
+    uintmax_t bw_limit;
+
+    /* Whether to run the operation with idle I/O scheduling class */
+    gboolean idle_io;
+
+    /* Whether to drop copied data from the page cache */
+    gboolean drop_cache;
+
     /* Preserve the original files' owner, group, permissions, and
      * timestamps (owner, group only as root).
      */
@@ -175,6 +188,14 @@ typedef struct
     double eta_secs;
 
     gboolean ask_overwrite;
+
+    /* State of speed limiter: time of last refill (us) and available bytes */
+    guint64 throttle_time;
+    gint64 throttle_tokens;
+
+    /* Results of verification */
+    size_t verify_ok_count;
+    size_t verify_failed_count;
 } file_op_total_context_t;
 
 /*** global variables defined in .c file *********************************************************/
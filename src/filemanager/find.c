@@ -1759,14 +1759,14 @@ do_find (const char *start_dir, ssize_t start_dir_len, const char *ignore_dirs,
             if (list->len == 0) /* first turn i.e clean old list */
                 panel_clean_dir (current_panel);
             list->list[list->len].fnamelen = strlen (p);
-            list->list[list->len].fname = g_strndup (p, list->list[list->len].fnamelen);
+            list->list[list->len].fname =
+                dir_list_name_new (list, p, list->list[list->len].fnamelen);
             list->list[list->len].f.marked = 0;
             list->list[list->len].f.link_to_dir = link_to_dir;
             list->list[list->len].f.stale_link = stale_link;
             list->list[list->len].f.dir_size_computed = 0;
             list->list[list->len].st = st;
-            list->list[list->len].sort_key = NULL;
-            list->list[list->len].second_sort_key = NULL;
+            list->list[list->len].fhl_id = 0;
             list->len++;
             g_free (name);
             if ((list->len & 15) == 0)
@@ -124,6 +124,7 @@ info_show_info (WInfo * info)
     if (get_current_type () != view_listing)
         return;
 
+    init_my_statfs ();
     my_statfs (&myfs_stats, vfs_path_as_str (current_panel->cwd_vpath));
 
     st = current_panel->dir.list[current_panel->selected].st;
@@ -147,6 +148,16 @@ info_show_info (WInfo * info)
 
     default:
 
+    case 17:
+        widget_move (w, 17, 3);
+        {
+            char buffer[6];
+
+            size_trunc_len (buffer, 5, dir_list_get_mem_usage (&current_panel->dir), 1,
+                            panels_options.kilobyte_si);
+            tty_printf (_("Listing:    %d files, %s"), current_panel->dir.len, buffer);
+        }
+
     case 16:
         widget_move (w, 16, 3);
         if (myfs_stats.nfree == 0 && myfs_stats.nodes == 0)
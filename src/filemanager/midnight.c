@@ -71,6 +71,7 @@
 #include "panelize.h"
 #include "command.h"            /* cmdline */
 #include "dir.h"                /* dir_list_clean() */
+#include "dirwatch.h"
 
 #include "chmod.h"
 #include "chown.h"
@@ -130,6 +131,9 @@ static menu_t *left_menu, *right_menu;
 
 static gboolean ctl_x_map_enabled = FALSE;
 
+/* the first idle event after start is not handled yet */
+static gboolean first_idle = TRUE;
+
 /*** file scope functions ************************************************************************/
 
 /** Stop MC main dialog and the current dialog if it exists.
@@ -915,6 +919,8 @@ done_mc (void)
      */
     const char *curr_dir;
 
+    dir_watch_done ();
+
     save_setup (auto_save_setup, panels_options.auto_save_setup);
 
     curr_dir = vfs_get_current_dir ();
@@ -1075,10 +1081,10 @@ static void
 update_dirty_panels (void)
 {
     if (get_current_type () == view_listing && current_panel->dirty)
-        widget_redraw (WIDGET (current_panel));
+        panel_redraw_dirty (current_panel);
 
     if (get_other_type () == view_listing && other_panel->dirty)
-        widget_redraw (WIDGET (other_panel));
+        panel_redraw_dirty (other_panel);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -1422,9 +1428,17 @@ midnight_callback (Widget * w, Widget * sender, widget_msg_t msg, int parm, void
         return MSG_HANDLED;
 
     case MSG_IDLE:
-        /* We only need the first idle event to show user menu after start */
         widget_want_idle (w, FALSE);
 
+        /* show changes of file system made by others */
+        if (dir_watch_process ())
+            update_dirty_panels ();
+
+        /* We only need the first idle event to show user menu after start */
+        if (!first_idle)
+            return MSG_HANDLED;
+        first_idle = FALSE;
+
         if (boot_current_is_left)
             dlg_select_widget (get_panel_widget (0));
         else
@@ -1766,7 +1780,7 @@ do_nc (void)
         /* don't handle VFS timestamps for dirs opened in panels */
         mc_event_destroy (MCEVENT_GROUP_CORE, "vfs_timestamp");
 
-        dir_list_clean (&panelized_panel.list);
+        dir_list_free_list (&panelized_panel.list);
     }
 
     /* Program end */
@@ -184,8 +184,18 @@
 #include <sys/statvfs.h>
 #endif
 
+#include <signal.h>             /* kill() */
+#include <sys/wait.h>           /* waitpid() */
+#ifdef __linux__
+#include <poll.h>
+#endif
+
 #include "lib/global.h"
 #include "lib/strutil.h"        /* str_verscmp() */
+#include "lib/timer.h"
+#include "lib/util.h"           /* mc_time_elapsed() */
+#include "lib/tty/key.h"        /* add_select_channel(), delete_select_channel() */
+#include "lib/widget.h"         /* repaint_screen() */
 #include "mountlist.h"
 
 /*** global variables ****************************************************************************/
@@ -200,6 +210,15 @@
 #define HAVE_INFOMOUNT
 #endif
 
+/* free space of file system is asked again after this time, in microseconds */
+#define FS_USAGE_CACHE_TIME (2 * G_USEC_PER_SEC)
+/* remote file system which doesn't answer in this time is shown as unknown */
+#define FS_USAGE_TIMEOUT (5 * G_USEC_PER_SEC)
+/* file system which doesn't answer is asked again after doubled time, but not more rarely */
+#define FS_USAGE_RETRY_MAX (5 * 60 * G_USEC_PER_SEC)
+/* mount table is reread at most once per this time if its changes can't be polled */
+#define MOUNT_LIST_REFRESH_TIME (2 * G_USEC_PER_SEC)
+
 /* The results of opendir() in this file are not used with dirfd and fchdir,
    therefore save some unnecessary work in fchdir.c.  */
 #undef opendir
@@ -344,10 +363,36 @@ struct fs_usage
     uintmax_t fsu_ffree;        /* Free file nodes. */
 };
 
+#ifdef HAVE_INFOMOUNT_LIST
+/* cached space usage of mounted file system */
+typedef struct
+{
+    char *mountdir;
+    struct fs_usage usage;
+    gboolean valid;             /* usage is known */
+    gboolean checked;           /* usage was asked at least once */
+    guint64 time;               /* when usage was got */
+    guint64 retry;              /* usage is asked again after this time since it was got */
+    pid_t pid;                  /* helper which asks remote file system, 0 if none */
+    int fd;                     /* pipe from helper */
+    guint64 started;            /* when helper was started */
+    gboolean killed;            /* helper didn't answer in time */
+} fs_usage_entry_t;
+#endif /* HAVE_INFOMOUNT_LIST */
+
 /*** file scope variables ************************************************************************/
 
 #ifdef HAVE_INFOMOUNT_LIST
 static GSList *mc_mount_list = NULL;
+
+/* mount point -> fs_usage_entry_t */
+static GHashTable *fs_usage_cache = NULL;
+
+#ifdef __linux__
+/* signals changes of mount table */
+static int mountinfo_fd = -1;
+#endif
+static guint64 mount_list_time = 0;
 #endif /* HAVE_INFOMOUNT_LIST */
 
 /*** file scope functions ************************************************************************/
@@ -1674,6 +1719,237 @@ get_fs_usage (char const *file, char const *disk, struct fs_usage *fsp)
 }
 #endif /* HAVE_INFOMOUNT */
 
+#ifdef HAVE_INFOMOUNT_LIST
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check whether mount table is changed since the last call.
+ * On Linux, changes are polled on /proc/self/mountinfo, otherwise the table is
+ * considered changed from time to time.
+ */
+
+static gboolean
+mount_list_changed (void)
+{
+#ifdef __linux__
+    if (mountinfo_fd == -1)
+    {
+        mountinfo_fd = open ("/proc/self/mountinfo", O_RDONLY);
+        if (mountinfo_fd != -1)
+        {
+            fcntl (mountinfo_fd, F_SETFD, FD_CLOEXEC);
+            return TRUE;
+        }
+    }
+    else
+    {
+        struct pollfd pfd;
+
+        pfd.fd = mountinfo_fd;
+        pfd.events = POLLPRI;
+        pfd.revents = 0;
+
+        if (poll (&pfd, 1, 0) == -1)
+            return TRUE;
+
+        return ((pfd.revents & (POLLERR | POLLPRI)) != 0);
+    }
+#endif /* __linux__ */
+
+    return mc_time_elapsed (&mount_list_time, MOUNT_LIST_REFRESH_TIME);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+ * Reap killed helper. Helper hung in file system can't exit at once, so it is waited for
+ * until its pipe is closed.
+ */
+
+static int
+fs_usage_reap_callback (int fd, void *info)
+{
+    char buf[sizeof (struct fs_usage)];
+    ssize_t n;
+
+    while ((n = read (fd, buf, sizeof (buf))) == -1 && errno == EINTR)
+        ;
+
+    /* late answer: wait for exit */
+    if (n > 0)
+        return 0;
+
+    delete_select_channel (fd);
+    close (fd);
+    /* the pipe is closed when helper exits */
+    (void) waitpid ((pid_t) GPOINTER_TO_INT (info), NULL, 0);
+
+    return 0;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+fs_usage_entry_free (fs_usage_entry_t * e)
+{
+    if (e->pid != 0)
+    {
+        kill (e->pid, SIGKILL);
+        /* reap helper when it really exits */
+        delete_select_channel (e->fd);
+        add_select_channel (e->fd, fs_usage_reap_callback, GINT_TO_POINTER ((int) e->pid));
+    }
+
+    g_free (e->mountdir);
+    g_free (e);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static int
+fs_usage_helper_callback (int fd, void *info)
+{
+    fs_usage_entry_t *e = (fs_usage_entry_t *) info;
+    struct fs_usage fsu;
+    ssize_t n;
+
+    while ((n = read (fd, &fsu, sizeof (fsu))) == -1 && errno == EINTR)
+        ;
+
+    e->valid = (n == (ssize_t) sizeof (fsu) && !e->killed);
+    if (e->valid)
+    {
+        e->usage = fsu;
+        e->retry = FS_USAGE_CACHE_TIME;
+    }
+    else if (e->killed)
+    {
+        /* don't hang helpers on dead server too often */
+        e->retry = MIN (e->retry * 2, FS_USAGE_RETRY_MAX);
+    }
+    e->time = mc_timer_elapsed (mc_global.timer);
+
+    delete_select_channel (fd);
+    close (fd);
+    /* the helper exits right after the answer */
+    (void) waitpid (e->pid, NULL, 0);
+    e->pid = 0;
+    e->fd = -1;
+
+    repaint_screen ();
+
+    return 0;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Ask remote file system in the child process, so that hung server doesn't freeze us.
+ * The answer is handled by fs_usage_helper_callback().
+ */
+
+static void
+fs_usage_start_helper (fs_usage_entry_t * e)
+{
+    int fds[2];
+    pid_t pid;
+
+    if (pipe (fds) == -1)
+        return;
+
+    pid = fork ();
+    if (pid == -1)
+    {
+        close (fds[0]);
+        close (fds[1]);
+        return;
+    }
+
+    if (pid == 0)
+    {
+        struct fs_usage fsu;
+
+        close (fds[0]);
+        memset (&fsu, 0, sizeof (fsu));
+        if (get_fs_usage (e->mountdir, NULL, &fsu) == 0)
+            (void) write (fds[1], &fsu, sizeof (fsu));
+        _exit (0);
+    }
+
+    close (fds[1]);
+    fcntl (fds[0], F_SETFD, FD_CLOEXEC);
+
+    e->pid = pid;
+    e->fd = fds[0];
+    e->started = mc_timer_elapsed (mc_global.timer);
+    e->killed = FALSE;
+
+    add_select_channel (e->fd, fs_usage_helper_callback, e);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get cached space usage of file system. Local file systems are asked directly,
+ * remote ones in background.
+ *
+ * @param me mount entry
+ * @param fsp where to store the usage
+ *
+ * @return TRUE if usage is known, FALSE otherwise
+ */
+
+static gboolean
+fs_usage_get (const struct mount_entry *me, struct fs_usage *fsp)
+{
+    fs_usage_entry_t *e;
+    guint64 now;
+
+    if (fs_usage_cache == NULL)
+        fs_usage_cache = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                                (GDestroyNotify) fs_usage_entry_free);
+
+    e = (fs_usage_entry_t *) g_hash_table_lookup (fs_usage_cache, me->me_mountdir);
+    if (e == NULL)
+    {
+        e = g_new0 (fs_usage_entry_t, 1);
+        e->mountdir = g_strdup (me->me_mountdir);
+        e->fd = -1;
+        e->retry = FS_USAGE_CACHE_TIME;
+        g_hash_table_insert (fs_usage_cache, e->mountdir, e);
+    }
+
+    now = mc_timer_elapsed (mc_global.timer);
+
+    if (e->pid != 0)
+    {
+        if (!e->killed && now - e->started >= FS_USAGE_TIMEOUT)
+        {
+            /* usage is unknown until file system answers again. The helper is reaped
+               when its pipe is closed */
+            kill (e->pid, SIGKILL);
+            e->killed = TRUE;
+            e->valid = FALSE;
+        }
+    }
+    else if (!e->checked || now - e->time >= e->retry)
+    {
+        e->checked = TRUE;
+
+        if (me->me_remote)
+            fs_usage_start_helper (e);
+        else
+        {
+            memset (&e->usage, 0, sizeof (e->usage));
+            e->valid = (get_fs_usage (e->mountdir, NULL, &e->usage) == 0);
+            e->time = now;
+        }
+    }
+
+    if (e->valid)
+        *fsp = e->usage;
+
+    return e->valid;
+}
+#endif /* HAVE_INFOMOUNT_LIST */
+
 /* --------------------------------------------------------------------------------------------- */
 /*** public functions ****************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
@@ -1684,22 +1960,48 @@ free_my_statfs (void)
 #ifdef HAVE_INFOMOUNT_LIST
     g_slist_free_full (mc_mount_list, (GDestroyNotify) free_mount_entry);
     mc_mount_list = NULL;
+
+    if (fs_usage_cache != NULL)
+    {
+        g_hash_table_destroy (fs_usage_cache);
+        fs_usage_cache = NULL;
+    }
+
+#ifdef __linux__
+    if (mountinfo_fd != -1)
+    {
+        close (mountinfo_fd);
+        mountinfo_fd = -1;
+    }
+#endif
 #endif /* HAVE_INFOMOUNT_LIST */
 }
 
 /* --------------------------------------------------------------------------------------------- */
+/**
+ * Read the mount table if it is changed since the last call. Cheap enough to be called
+ * on every redraw.
+ */
 
 void
 init_my_statfs (void)
 {
 #ifdef HAVE_INFOMOUNT_LIST
-    free_my_statfs ();
+    if (!mount_list_changed () && mc_mount_list != NULL)
+        return;
+
+    g_slist_free_full (mc_mount_list, (GDestroyNotify) free_mount_entry);
     mc_mount_list = read_file_system_list (1);
 #endif /* HAVE_INFOMOUNT_LIST */
 }
 
 /* --------------------------------------------------------------------------------------------- */
 
+/**
+ * Get status of file system which contains the path. Space usage is taken from cache
+ * and is zero while it is unknown.
+ */
+
 void
 my_statfs (struct my_statfs *myfs_stats, const char *path)
 {
@@ -1727,7 +2029,7 @@ my_statfs (struct my_statfs *myfs_stats, const char *path)
     if (entry != NULL)
     {
         memset (&fs_use, 0, sizeof (struct fs_usage));
-        get_fs_usage (entry->me_mountdir, NULL, &fs_use);
+        (void) fs_usage_get (entry, &fs_use);
 
         myfs_stats->type = entry->me_dev;
         myfs_stats->typename = entry->me_type;
@@ -1774,7 +2076,9 @@ my_statfs (struct my_statfs *myfs_stats, const char *path)
 #endif /* HAVE_INFOMOUNT_QNX */
     {
         myfs_stats->type = 0;
+        myfs_stats->typename = NULL;
         myfs_stats->mpoint = "unknown";
+        myfs_stats->mroot = NULL;
         myfs_stats->device = "unknown";
         myfs_stats->avail = 0;
         myfs_stats->total = 0;
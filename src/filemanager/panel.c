@@ -67,6 +67,7 @@
 #endif
 
 #include "dir.h"
+#include "dirwatch.h"
 #include "boxes.h"
 #include "tree.h"
 #include "ext.h"                /* regexp_command */
@@ -85,7 +86,7 @@
 hook_t *select_file_hook = NULL;
 
 /* *INDENT-OFF* */
-panelized_panel_t panelized_panel = { {NULL, 0, -1}, NULL };
+panelized_panel_t panelized_panel = { {NULL, 0, -1, NULL, {FALSE, FALSE, FALSE}, FALSE, NULL, 0}, NULL };
 /* *INDENT-ON* */
 
 static const char *string_file_name (file_entry_t *, int);
@@ -1035,30 +1036,118 @@ display_mini_info (WPanel * panel)
 }
 
 /* --------------------------------------------------------------------------------------------- */
+/** Forget what is painted in the row which shows the file */
+
+static void
+panel_row_invalidate (WPanel * panel, int file_index)
+{
+    int i;
+
+    i = file_index - panel->top_file;
+    if (i >= 0 && i < panel->rows_num)
+        panel->rows[i].file_index = -1;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/** Compare stat info which can be shown by any field of the listing format */
+
+static inline gboolean
+panel_row_same_stat (const struct stat *a, const struct stat *b)
+{
+    return (a->st_mode == b->st_mode && a->st_size == b->st_size && a->st_mtime == b->st_mtime
+            && a->st_atime == b->st_atime && a->st_ctime == b->st_ctime
+            && a->st_nlink == b->st_nlink && a->st_ino == b->st_ino && a->st_uid == b->st_uid
+            && a->st_gid == b->st_gid && a->st_rdev == b->st_rdev);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check whether the row shows the file in the same way.
+ *
+ * @param row painted row
+ * @param file_index index of file to be shown in the row
+ * @param fe file entry or NULL if row is empty
+ * @param attr attribute of file
+ *
+ * @return TRUE if the row should be repainted, FALSE otherwise
+ */
+
+static gboolean
+panel_row_changed (const panel_row_t * row, int file_index, const file_entry_t * fe, int attr)
+{
+    if (row->file_index != file_index || row->attr != attr)
+        return TRUE;
+
+    if (fe == NULL)
+        return (row->fname != NULL);
+
+    return (row->fname != fe->fname || row->link_to_dir != fe->f.link_to_dir
+            || row->stale_link != fe->f.stale_link
+            || row->dir_size_computed != fe->f.dir_size_computed
+            || !panel_row_same_stat (&row->st, &fe->st));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Paint rows of file list. Rows which already show the same are skipped,
+ * so moving of cursor costs repainting of two rows only.
+ */
 
 static void
 paint_dir (WPanel * panel)
 {
     int i;
     int items;                  /* Number of items */
+    int max_shift = -1;
 
     items = panel_items (panel);
-    /* reset max len of filename because we have the new max length for the new file list */
-    panel->max_shift = -1;
+
+    if (panel->rows_num != items)
+    {
+        panel->rows = g_renew (panel_row_t, panel->rows, items);
+        panel->rows_num = items;
+        panel_rows_invalidate (panel);
+    }
 
     for (i = 0; i < items; i++)
     {
+        int file_index = i + panel->top_file;
         int color = 0;          /* Color value of the line */
+        file_entry_t *fe = NULL;
+        panel_row_t *row = &panel->rows[i];
+
+        if (file_index < panel->dir.len)
+        {
+            fe = &panel->dir.list[file_index];
+            color = 2 * (fe->f.marked);
+            color += (panel->selected == file_index && panel->active);
+        }
 
-        if (i + panel->top_file < panel->dir.len)
+        if (panel_row_changed (row, file_index, fe, color))
         {
-            color = 2 * (panel->dir.list[i + panel->top_file].f.marked);
-            color += (panel->selected == i + panel->top_file && panel->active);
+            /* get max len of filename of this row */
+            panel->max_shift = -1;
+            repaint_file (panel, file_index, TRUE, color, FALSE);
+
+            row->file_index = file_index;
+            row->attr = color;
+            row->fname = fe != NULL ? fe->fname : NULL;
+            if (fe != NULL)
+            {
+                row->st = fe->st;
+                row->link_to_dir = fe->f.link_to_dir;
+                row->stale_link = fe->f.stale_link;
+                row->dir_size_computed = fe->f.dir_size_computed;
+            }
+            row->max_shift = panel->max_shift;
         }
 
-        repaint_file (panel, i + panel->top_file, TRUE, color, FALSE);
+        max_shift = max (max_shift, row->max_shift);
     }
 
+    /* we have the new max length for the new file list */
+    panel->max_shift = max_shift;
+
     tty_set_normal_attrs ();
 }
 
@@ -1132,9 +1221,10 @@ static void
 show_free_space (const WPanel * panel)
 {
     /* Used to figure out how many free space we have */
-    static struct my_statfs myfs_stats;
+    struct my_statfs myfs_stats;
     /* Old current working directory for displaying free space */
     static char *old_cwd = NULL;
+    static char rpath[PATH_MAX];
 
     /* Don't try to stat non-local fs */
     if (!vfs_file_is_local (panel->cwd_vpath) || !free_space)
@@ -1142,18 +1232,20 @@ show_free_space (const WPanel * panel)
 
     if (old_cwd == NULL || strcmp (old_cwd, vfs_path_as_str (panel->cwd_vpath)) != 0)
     {
-        char rpath[PATH_MAX];
-
-        init_my_statfs ();
         g_free (old_cwd);
         old_cwd = g_strdup (vfs_path_as_str (panel->cwd_vpath));
 
         if (mc_realpath (old_cwd, rpath) == NULL)
-            return;
-
-        my_statfs (&myfs_stats, rpath);
+            rpath[0] = '\0';
     }
 
+    if (rpath[0] == '\0')
+        return;
+
+    /* mount table and free space are cached, so they are not asked on every redraw */
+    init_my_statfs ();
+    my_statfs (&myfs_stats, rpath);
+
     if (myfs_stats.avail != 0 || myfs_stats.total != 0)
     {
         Widget *w = WIDGET (panel);
@@ -1494,7 +1586,8 @@ panel_destroy (WPanel * p)
     for (i = 0; i < LIST_TYPES; i++)
         g_free (p->user_status_format[i]);
 
-    g_free (p->dir.list);
+    dir_list_free_list (&p->dir);
+    g_free (p->rows);
     g_free (p->panel_name);
 
     vfs_path_free (p->lwd_vpath);
@@ -2030,6 +2123,7 @@ static inline void
 unselect_item (WPanel * panel)
 {
     repaint_file (panel, panel->selected, TRUE, 2 * selection (panel)->f.marked, FALSE);
+    panel_row_invalidate (panel, panel->selected);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -3117,6 +3211,7 @@ panel_content_scroll_left (WPanel * panel)
             panel->content_shift = panel->max_shift;
 
         panel->content_shift--;
+        panel_rows_invalidate (panel);
         show_dir (panel);
         paint_dir (panel);
     }
@@ -3138,6 +3233,7 @@ panel_content_scroll_right (WPanel * panel)
     if (panel->content_shift < 0 || panel->content_shift < panel->max_shift)
     {
         panel->content_shift++;
+        panel_rows_invalidate (panel);
         show_dir (panel);
         paint_dir (panel);
     }
@@ -3273,6 +3369,7 @@ _do_panel_cd (WPanel * panel, const vfs_path_t * new_dir_vpath, enum cd_enum cd_
     load_hint (0);
     panel->dirty = 1;
     update_xterm_title_path ();
+    dir_watch_sync ();
 
     vfs_path_free (olddir_vpath);
 
@@ -3602,6 +3699,21 @@ panel_key (WPanel * panel, int key)
     return MSG_NOT_HANDLED;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/** Paint frame, header, file list and mini status of panel */
+
+static void
+panel_paint (WPanel * panel)
+{
+    show_dir (panel);
+    panel_print_header (panel);
+    adjust_top_file (panel);
+    paint_dir (panel);
+    mini_info_separator (panel);
+    display_mini_info (panel);
+    panel->dirty = 0;
+}
+
 /* --------------------------------------------------------------------------------------------- */
 
 static cb_ret_t
@@ -3622,13 +3734,8 @@ panel_callback (Widget * w, Widget * sender, widget_msg_t msg, int parm, void *d
     case MSG_DRAW:
         /* Repaint everything, including frame and separator */
         widget_erase (w);
-        show_dir (panel);
-        panel_print_header (panel);
-        adjust_top_file (panel);
-        paint_dir (panel);
-        mini_info_separator (panel);
-        display_mini_info (panel);
-        panel->dirty = 0;
+        panel_rows_invalidate (panel);
+        panel_paint (panel);
         return MSG_HANDLED;
 
     case MSG_FOCUS:
@@ -3920,7 +4027,7 @@ panel_event (Gpm_Event * event, void *data)
 
   finish:
     if (panel->dirty)
-        widget_redraw (w);
+        panel_redraw_dirty (panel);
 
     return MOU_NORMAL;
 }
@@ -3951,10 +4058,10 @@ reload_panelized (WPanel * panel)
             do_file_mark (panel, i, 0);
         }
         vpath = vfs_path_from_str (list->list[i].fname);
-        if (mc_lstat (vpath, &list->list[i].st) != 0)
-            g_free (list->list[i].fname);
-        else
+        /* name of removed entry is freed with the list */
+        if (mc_lstat (vpath, &list->list[i].st) == 0)
         {
+            list->list[i].fhl_id = 0;
             if (list->list[i].f.marked)
                 do_file_mark (panel, i, 1);
             if (j != i)
@@ -3966,7 +4073,11 @@ reload_panelized (WPanel * panel)
     if (j == 0)
         dir_list_init (list);
     else
+    {
         list->len = j;
+        /* stat info is updated, so the order of list is unknown */
+        list->sort = NULL;
+    }
 
     if (panel != current_panel)
         (void) mc_chdir (current_panel->cwd_vpath);
@@ -3974,7 +4085,7 @@ reload_panelized (WPanel * panel)
 
 /* --------------------------------------------------------------------------------------------- */
 
-static void
+void
 update_one_panel_widget (WPanel * panel, panel_update_flags_t flags, const char *current_file)
 {
     gboolean free_pointer;
@@ -4197,6 +4308,7 @@ panel_clean_dir (WPanel * panel)
     panel->dirty = 1;
     panel->content_shift = -1;
     panel->max_shift = -1;
+    panel_rows_invalidate (panel);
 
     dir_list_clean (&panel->dir);
 }
@@ -4398,11 +4510,14 @@ panel_reload (WPanel * panel)
     dir_list_reload (&panel->dir, panel->cwd_vpath, panel->sort_field->sort_routine,
                      &panel->sort_info, panel->filter);
 
+    /* names of the old list are freed */
+    panel_rows_invalidate (panel);
     panel->dirty = 1;
     if (panel->selected >= panel->dir.len)
         do_select (panel, panel->dir.len - 1);
 
     recalculate_panel_summary (panel);
+    dir_watch_sync ();
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -4428,6 +4543,7 @@ set_panel_formats (WPanel * p)
     {
         delete_format (p->format);
         p->format = form;
+        panel_rows_invalidate (p);
     }
 
     if (panels_options.show_mini_info)
@@ -4503,6 +4619,40 @@ panel_update_cols (Widget * widget, panel_display_t frame_size)
 
     widget->cols = cols;
     widget->x = origin;
+    panel_rows_invalidate (PANEL (widget));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Repaint panel after change of its content or selection. Unlike MSG_DRAW, the panel
+ * isn't erased and only rows of file list which show something other than before are repainted.
+ *
+ * @param panel panel object
+ */
+
+void
+panel_redraw_dirty (WPanel * panel)
+{
+    WDialog *h = WIDGET (panel)->owner;
+
+    if (h != NULL && h->state == DLG_ACTIVE)
+        panel_paint (panel);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Forget what is painted in the rows of file list, so all rows will be repainted.
+ * Should be called after storage of names of directory list is freed: new names can get
+ * the same addresses, so the rows would be taken as unchanged.
+ */
+
+void
+panel_rows_invalidate (WPanel * panel)
+{
+    int i;
+
+    for (i = 0; i < panel->rows_num; i++)
+        panel->rows[i].file_index = -1;
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -4570,6 +4720,50 @@ recalculate_panel_summary (WPanel * panel)
         }
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Update entries of the panel after files were created, deleted or changed by others,
+ * without reloading of the whole directory. Marks of entries and selection are kept.
+ *
+ * @param panel panel
+ * @param fnames set of names of changed files in the directory of panel
+ */
+
+void
+panel_update_files (WPanel * panel, GHashTable * fnames)
+{
+    GHashTable *marked = NULL;
+    int i;
+
+    /* names of removed entries stay valid until the list is cleaned */
+    for (i = 0; i < panel->dir.len; i++)
+    {
+        char *fname = panel->dir.list[i].fname;
+
+        if (panel->dir.list[i].f.marked && g_hash_table_lookup_extended (fnames, fname, NULL, NULL))
+        {
+            if (marked == NULL)
+                marked = g_hash_table_new (g_str_hash, g_str_equal);
+            g_hash_table_insert (marked, fname, fname);
+            do_file_mark (panel, i, 0);
+        }
+    }
+
+    dir_list_update_files (&panel->dir, panel->cwd_vpath, fnames, panel->filter,
+                           &panel->selected);
+
+    if (marked != NULL)
+    {
+        for (i = 0; i < panel->dir.len; i++)
+            if (g_hash_table_lookup_extended (marked, panel->dir.list[i].fname, NULL, NULL))
+                do_file_mark (panel, i, 1);
+
+        g_hash_table_destroy (marked);
+    }
+
+    select_item (panel);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /** This routine marks a file or a directory */
 
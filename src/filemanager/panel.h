@@ -88,6 +88,19 @@ typedef struct
     vfs_path_t *root_vpath;
 } panelized_panel_t;
 
+/* what is painted in the row of file list */
+typedef struct
+{
+    int file_index;             /* index of painted file, -1 if row should be repainted */
+    int attr;                   /* attribute the file is painted with */
+    const char *fname;          /* name, stat info and flags of painted file */
+    struct stat st;
+    unsigned int link_to_dir:1;
+    unsigned int stale_link:1;
+    unsigned int dir_size_computed:1;
+    int max_shift;              /* max shift of the file name */
+} panel_row_t;
+
 typedef struct
 {
     Widget widget;
@@ -140,6 +153,9 @@ typedef struct
     int search_chpoint;         /*point after last characters in search_char */
     int content_shift;          /* Number of characters of filename need to skip from left side. */
     int max_shift;              /* Max shift for visible part of current panel */
+
+    panel_row_t *rows;          /* Painted rows of file list */
+    int rows_num;               /* Number of elements in rows */
 } WPanel;
 
 /*** global variables defined in .c file *********************************************************/
@@ -167,17 +183,22 @@ vfs_path_t *remove_encoding_from_path (const vfs_path_t * vpath);
 #endif
 
 void update_panels (panel_update_flags_t flags, const char *current_file);
+void update_one_panel_widget (WPanel * panel, panel_update_flags_t flags,
+                              const char *current_file);
 int set_panel_formats (WPanel * p);
 void panel_update_cols (Widget * widget, panel_display_t frame_size);
+void panel_redraw_dirty (WPanel * panel);
 
 void try_to_select (WPanel * panel, const char *name);
 
 void unmark_files (WPanel * panel);
+void panel_rows_invalidate (WPanel * panel);
 void select_item (WPanel * panel);
 
 void recalculate_panel_summary (WPanel * panel);
 void file_mark (WPanel * panel, int idx, int val);
 void do_file_mark (WPanel * panel, int idx, int val);
+void panel_update_files (WPanel * panel, GHashTable * fnames);
 
 gboolean do_panel_cd (WPanel * panel, const vfs_path_t * new_dir_vpath, enum cd_enum cd_type);
 
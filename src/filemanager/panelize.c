@@ -392,6 +392,8 @@ do_panelize_cd (WPanel * panel)
     gboolean panelized_same;
 
     dir_list_clean (&panel->dir);
+    /* new names can get addresses of freed ones */
+    panel_rows_invalidate (panel);
     if (panelized_panel.root_vpath == NULL)
         panelize_change_root (current_panel->cwd_vpath);
 
@@ -411,8 +413,8 @@ do_panelize_cd (WPanel * panel)
         if (panelized_same || DIR_IS_DOTDOT (panelized_panel.list.list[i].fname))
         {
             list->list[i].fnamelen = panelized_panel.list.list[i].fnamelen;
-            list->list[i].fname = g_strndup (panelized_panel.list.list[i].fname,
-                                             panelized_panel.list.list[i].fnamelen);
+            list->list[i].fname = dir_list_name_new (list, panelized_panel.list.list[i].fname,
+                                                     panelized_panel.list.list[i].fnamelen);
         }
         else
         {
@@ -424,7 +426,7 @@ do_panelize_cd (WPanel * panel)
                                      NULL);
             fname = vfs_path_as_str (tmp_vpath);
             list->list[i].fnamelen = strlen (fname);
-            list->list[i].fname = g_strndup (fname, list->list[i].fnamelen);
+            list->list[i].fname = dir_list_name_new (list, fname, list->list[i].fnamelen);
             vfs_path_free (tmp_vpath);
         }
         list->list[i].f.link_to_dir = panelized_panel.list.list[i].f.link_to_dir;
@@ -432,8 +434,7 @@ do_panelize_cd (WPanel * panel)
         list->list[i].f.dir_size_computed = panelized_panel.list.list[i].f.dir_size_computed;
         list->list[i].f.marked = panelized_panel.list.list[i].f.marked;
         list->list[i].st = panelized_panel.list.list[i].st;
-        list->list[i].sort_key = panelized_panel.list.list[i].sort_key;
-        list->list[i].second_sort_key = panelized_panel.list.list[i].second_sort_key;
+        list->list[i].fhl_id = 0;
     }
     try_to_select (panel, NULL);
 }
@@ -476,14 +477,12 @@ panelize_save_panel (WPanel * panel)
     {
         panelized_panel.list.list[i].fnamelen = list->list[i].fnamelen;
         panelized_panel.list.list[i].fname =
-            g_strndup (list->list[i].fname, list->list[i].fnamelen);
+            dir_list_name_new (&panelized_panel.list, list->list[i].fname, list->list[i].fnamelen);
         panelized_panel.list.list[i].f.link_to_dir = list->list[i].f.link_to_dir;
         panelized_panel.list.list[i].f.stale_link = list->list[i].f.stale_link;
         panelized_panel.list.list[i].f.dir_size_computed = list->list[i].f.dir_size_computed;
         panelized_panel.list.list[i].f.marked = list->list[i].f.marked;
         panelized_panel.list.list[i].st = list->list[i].st;
-        panelized_panel.list.list[i].sort_key = list->list[i].sort_key;
-        panelized_panel.list.list[i].second_sort_key = list->list[i].second_sort_key;
     }
 }
 
@@ -54,7 +54,6 @@
 #include "lib/mcconfig.h"
 #include "lib/vfs/vfs.h"
 #include "lib/fileloc.h"
-#include "lib/strescape.h"
 #include "lib/hook.h"
 #include "lib/util.h"
 
@@ -68,6 +67,16 @@
 
 #define TREE_SIGNATURE "Midnight Commander TreeStore v 2.0"
 
+/* binary format: signature, then records of entries in the order of the list:
+ *   parent (guint32 LE): index of record of parent directory or TREE_NO_PARENT
+ *   scanned (guint8)
+ *   length (guint16 LE) and bytes of name: the last part of path if parent is set,
+ *   or full path otherwise
+ */
+#define TREE_BIN_SIGNATURE "MC TreeStore\0\3"
+#define TREE_BIN_SIGNATURE_LEN (sizeof (TREE_BIN_SIGNATURE) - 1)
+#define TREE_NO_PARENT G_MAXUINT32
+
 /*** file scope type declarations ****************************************************************/
 
 /*** file scope variables ************************************************************************/
@@ -89,27 +98,6 @@ tree_store_dirty (int state)
     ts.dirty = state;
 }
 
-/* --------------------------------------------------------------------------------------------- */
-/**
-  *
-  * @return the number of common bytes in the strings.
-  */
-
-static size_t
-str_common (const vfs_path_t * s1_vpath, const vfs_path_t * s2_vpath)
-{
-    size_t result = 0;
-    const char *s1, *s2;
-
-    s1 = vfs_path_as_str (s1_vpath);
-    s2 = vfs_path_as_str (s2_vpath);
-
-    while (*s1 != '\0' && *s2 != '\0' && *s1++ == *s2++)
-        result++;
-
-    return result;
-}
-
 /* --------------------------------------------------------------------------------------------- */
 /** The directory names are arranged in a single linked list in the same
   * order as they are displayed. When the tree is displayed the expected
@@ -162,6 +150,16 @@ pathcmp (const vfs_path_t * p1_vpath, const vfs_path_t * p2_vpath)
 
 /* --------------------------------------------------------------------------------------------- */
 
+static int
+tree_entry_compare (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    (void) user_data;
+
+    return pathcmp (((const tree_entry *) a)->name, ((const tree_entry *) b)->name);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
 static char *
 decode (char *buffer)
 {
@@ -202,7 +200,108 @@ decode (char *buffer)
 }
 
 /* --------------------------------------------------------------------------------------------- */
-/** Loads the tree store from the specified filename */
+/**
+ * Load the tree store from the file in binary format.
+ * The file is mapped into memory and paths are built from the paths of parent records.
+ *
+ * @param name file name
+ *
+ * @return TRUE if file is in binary format, FALSE otherwise
+ */
+
+static gboolean
+tree_store_load_binary (const char *name)
+{
+    GMappedFile *mapped;
+    const char *data, *p, *end;
+    GPtrArray *entries;
+    GString *path;
+
+    mapped = g_mapped_file_new (name, FALSE, NULL);
+    if (mapped == NULL)
+        return FALSE;
+
+    data = g_mapped_file_get_contents (mapped);
+    end = data + g_mapped_file_get_length (mapped);
+
+    if ((size_t) (end - data) < TREE_BIN_SIGNATURE_LEN
+        || memcmp (data, TREE_BIN_SIGNATURE, TREE_BIN_SIGNATURE_LEN) != 0)
+    {
+        g_mapped_file_unref (mapped);
+        return FALSE;
+    }
+
+    ts.loaded = TRUE;
+
+    /* entries by index of record, NULL for skipped ones */
+    entries = g_ptr_array_new ();
+    path = g_string_sized_new (MC_MAXPATHLEN);
+
+    /* record header is 7 bytes long */
+    for (p = data + TREE_BIN_SIGNATURE_LEN; end - p >= 7;)
+    {
+        guint32 parent;
+        guint16 len;
+        gboolean scanned;
+        tree_entry *e = NULL;
+
+        memcpy (&parent, p, sizeof (parent));
+        parent = GUINT32_FROM_LE (parent);
+        scanned = p[4] != 0;
+        memcpy (&len, p + 5, sizeof (len));
+        len = GUINT16_FROM_LE (len);
+        p += 7;
+
+        if (end - p < len)
+            break;
+
+        g_string_truncate (path, 0);
+
+        if (parent != TREE_NO_PARENT)
+        {
+            const tree_entry *pe = NULL;
+
+            if (parent < entries->len)
+                pe = (const tree_entry *) g_ptr_array_index (entries, parent);
+
+            if (pe != NULL)
+            {
+                g_string_append (path, vfs_path_as_str (pe->name));
+                if (!IS_PATH_SEP (path->str[path->len - 1]))
+                    g_string_append_c (path, PATH_SEP);
+            }
+        }
+
+        if (parent == TREE_NO_PARENT || path->len != 0)
+        {
+            vfs_path_t *vpath;
+
+            g_string_append_len (path, p, len);
+
+            vpath = vfs_path_from_str_flags (path->str, VPF_NO_CANON);
+            if (vfs_file_is_local (vpath))
+            {
+                e = tree_store_add_entry (vpath);
+                e->scanned = scanned;
+            }
+            vfs_path_free (vpath);
+        }
+
+        p += len;
+        g_ptr_array_add (entries, e);
+    }
+
+    g_string_free (path, TRUE);
+    g_ptr_array_free (entries, TRUE);
+    g_mapped_file_unref (mapped);
+
+    return TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/** Loads the tree store from the specified filename.
+ * The file in old text format is loaded too and will be saved in binary one.
+ */
 
 static int
 tree_store_load_from (char *name)
@@ -216,7 +315,10 @@ tree_store_load_from (char *name)
     if (ts.loaded)
         return TRUE;
 
-    file = fopen (name, "r");
+    if (tree_store_load_binary (name))
+        file = NULL;
+    else
+        file = fopen (name, "r");
 
     if (file)
     {
@@ -322,14 +424,6 @@ tree_store_load_from (char *name)
     return TRUE;
 }
 
-/* --------------------------------------------------------------------------------------------- */
-
-static char *
-encode (const vfs_path_t * vpath, size_t offset)
-{
-    return strutils_escape (vfs_path_as_str (vpath) + offset, -1, "\n\\", FALSE);
-}
-
 /* --------------------------------------------------------------------------------------------- */
 /** Saves the tree to the specified filename */
 
@@ -338,49 +432,92 @@ tree_store_save_to (char *name)
 {
     tree_entry *current;
     FILE *file;
+    GHashTable *indexes;
+    guint32 index = 0;
+    int ret = 0;
 
     file = fopen (name, "w");
-    if (!file)
+    if (file == NULL)
         return errno;
 
-    fprintf (file, "%s\n", TREE_SIGNATURE);
+    /* entry -> index of its record + 1 */
+    indexes = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    if (fwrite (TREE_BIN_SIGNATURE, TREE_BIN_SIGNATURE_LEN, 1, file) != 1)
+        ret = errno;
 
-    current = ts.tree_first;
-    while (current)
+    for (current = ts.tree_first; ret == 0 && current != NULL; current = current->next)
     {
-        if (vfs_file_is_local (current->name))
-        {
-            int i, common;
+        const char *path, *subname;
+        guint32 parent = TREE_NO_PARENT;
+        guint8 scanned;
+        guint16 len;
+        size_t subname_len;
 
-            /* Clear-text compression */
-            if (current->prev && (common = str_common (current->prev->name, current->name)) > 2)
-            {
-                char *encoded = encode (current->name, common);
+        if (!vfs_file_is_local (current->name))
+            continue;
 
-                i = fprintf (file, "%d:%d %s\n", current->scanned, common, encoded);
-                g_free (encoded);
-            }
+        path = vfs_path_as_str (current->name);
+        subname = path;
+
+        /* parent precedes its subdirectories in the list */
+        if (current->subname > path)
+        {
+            char *parent_path;
+            tree_entry *p;
+
+            if (current->subname - path > 1)
+                parent_path = g_strndup (path, current->subname - path - 1);
             else
-            {
-                char *encoded = encode (current->name, 0);
+                parent_path = g_strdup (PATH_SEP_STR);
 
-                i = fprintf (file, "%d:%s\n", current->scanned, encoded);
-                g_free (encoded);
-            }
+            p = (tree_entry *) g_hash_table_lookup (ts.paths, parent_path);
+            g_free (parent_path);
 
-            if (i == EOF)
+            if (p != NULL)
             {
-                fprintf (stderr, _("Cannot write to the %s file:\n%s\n"),
-                         name, unix_error_string (errno));
-                break;
+                gpointer idx;
+
+                idx = g_hash_table_lookup (indexes, p);
+                if (idx != NULL)
+                {
+                    parent = GPOINTER_TO_UINT (idx) - 1;
+                    subname = current->subname;
+                }
             }
         }
-        current = current->next;
+
+        subname_len = strlen (subname);
+        if (subname_len > G_MAXUINT16)
+            continue;
+
+        parent = GUINT32_TO_LE (parent);
+        scanned = current->scanned;
+        len = GUINT16_TO_LE ((guint16) subname_len);
+
+        if (fwrite (&parent, sizeof (parent), 1, file) != 1
+            || fwrite (&scanned, sizeof (scanned), 1, file) != 1
+            || fwrite (&len, sizeof (len), 1, file) != 1
+            || (subname_len != 0 && fwrite (subname, subname_len, 1, file) != 1))
+        {
+            ret = errno;
+            fprintf (stderr, _("Cannot write to the %s file:\n%s\n"), name,
+                     unix_error_string (ret));
+            break;
+        }
+
+        g_hash_table_insert (indexes, current, GUINT_TO_POINTER (++index));
     }
-    tree_store_dirty (FALSE);
-    fclose (file);
 
-    return 0;
+    g_hash_table_destroy (indexes);
+
+    if (fclose (file) != 0 && ret == 0)
+        ret = errno;
+
+    if (ret == 0)
+        tree_store_dirty (FALSE);
+
+    return ret;
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -388,8 +525,7 @@ tree_store_save_to (char *name)
 static tree_entry *
 tree_store_add_entry (const vfs_path_t * name)
 {
-    int flag = -1;
-    tree_entry *current = ts.tree_first;
+    tree_entry *current;
     tree_entry *old = NULL;
     tree_entry *new;
     int submask = 0;
@@ -397,57 +533,49 @@ tree_store_add_entry (const vfs_path_t * name)
     if (ts.tree_last && ts.tree_last->next)
         abort ();
 
-    /* Search for the correct place */
-    while (current != NULL && (flag = pathcmp (current->name, name)) < 0)
+    if (ts.paths == NULL)
     {
-        old = current;
-        current = current->next;
+        ts.paths = g_hash_table_new (g_str_hash, g_str_equal);
+        ts.order = g_sequence_new (NULL);
     }
 
-    if (flag == 0)
+    current = (tree_entry *) g_hash_table_lookup (ts.paths, vfs_path_as_str (name));
+    if (current != NULL)
         return current;         /* Already in the list */
 
     /* Not in the list -> add it */
     new = g_new0 (tree_entry, 1);
-    if (!current)
+    new->name = vfs_path_clone (name);
+
+    /* Search for the correct place. Entries are loaded in sorted order, so try the end first */
+    if (ts.tree_last == NULL || pathcmp (ts.tree_last->name, name) < 0)
+        new->order_iter = g_sequence_append (ts.order, new);
+    else
+        new->order_iter = g_sequence_insert_sorted (ts.order, new, tree_entry_compare, NULL);
+
+    if (!g_sequence_iter_is_begin (new->order_iter))
+        old = (tree_entry *) g_sequence_get (g_sequence_iter_prev (new->order_iter));
+
+    g_hash_table_insert (ts.paths, (gpointer) vfs_path_as_str (new->name), new);
+
+    /* Link to the list */
+    new->prev = old;
+    if (old != NULL)
     {
-        /* Append to the end of the list */
-        if (!ts.tree_first)
-        {
-            /* Empty list */
-            ts.tree_first = new;
-            new->prev = NULL;
-        }
-        else
-        {
-            if (old != NULL)
-                old->next = new;
-            new->prev = old;
-        }
-        new->next = NULL;
-        ts.tree_last = new;
+        new->next = old->next;
+        old->next = new;
     }
     else
     {
-        /* Insert in to the middle of the list */
-        new->prev = old;
-        if (old != NULL)
-        {
-            /* Yes, in the middle */
-            new->next = old->next;
-            old->next = new;
-        }
-        else
-        {
-            /* Nope, in the beginning of the list */
-            new->next = ts.tree_first;
-            ts.tree_first = new;
-        }
-        new->next->prev = new;
+        new->next = ts.tree_first;
+        ts.tree_first = new;
     }
+    if (new->next != NULL)
+        new->next->prev = new;
+    else
+        ts.tree_last = new;
 
     /* Calculate attributes */
-    new->name = vfs_path_clone (name);
     new->sublevel = vfs_path_tokens_count (new->name);
     {
         const char *new_name;
@@ -529,6 +657,9 @@ remove_entry (tree_entry * entry)
     else
         ts.tree_last = entry->prev;
 
+    g_hash_table_remove (ts.paths, vfs_path_as_str (entry->name));
+    g_sequence_remove (entry->order_iter);
+
     /* Free the memory used by the entry */
     g_free (entry->name);
     g_free (entry);
@@ -603,16 +734,10 @@ should_skip_directory (const vfs_path_t * vpath)
 tree_entry *
 tree_store_whereis (const vfs_path_t * name)
 {
-    tree_entry *current = ts.tree_first;
-    int flag = -1;
-
-    while (current && (flag = pathcmp (current->name, name)) < 0)
-        current = current->next;
-
-    if (flag == 0)
-        return current;
-    else
+    if (ts.paths == NULL)
         return NULL;
+
+    return (tree_entry *) g_hash_table_lookup (ts.paths, vfs_path_as_str (name));
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -744,7 +869,6 @@ tree_store_mark_checked (const char *subname)
 {
     vfs_path_t *name;
     tree_entry *current, *base;
-    int flag = 1;
     const char *cname;
 
     if (!ts.loaded)
@@ -764,11 +888,9 @@ tree_store_mark_checked (const char *subname)
         name = vfs_path_append_new (ts.check_name, subname, NULL);
 
     /* Search for the subdirectory */
-    current = ts.check_start;
-    while (current && (flag = pathcmp (current->name, name)) < 0)
-        current = current->next;
+    current = tree_store_whereis (name);
 
-    if (flag != 0)
+    if (current == NULL)
     {
         /* Doesn't exist -> add it */
         current = tree_store_add_entry (name);
@@ -800,6 +922,36 @@ tree_store_mark_checked (const char *subname)
     }
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Add subdirectory created in the directory which is already in the tree.
+ *
+ * @param vpath directory
+ * @param subname name of new subdirectory
+ */
+
+void
+tree_store_add_subdir (const vfs_path_t * vpath, const char *subname)
+{
+    vfs_path_t *name;
+    const char *cname;
+
+    if (!ts.loaded || DIR_IS_DOT (subname) || DIR_IS_DOTDOT (subname))
+        return;
+
+    if (tree_store_whereis (vpath) == NULL)
+        return;
+
+    cname = vfs_path_as_str (vpath);
+    if (IS_PATH_SEP (cname[0]) && cname[1] == '\0')
+        name = vfs_path_build_filename (PATH_SEP_STR, subname, NULL);
+    else
+        name = vfs_path_append_new (vpath, subname, NULL);
+    if (tree_store_whereis (name) == NULL)
+        tree_store_add_entry (name);
+    vfs_path_free (name);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /** Mark the subdirectories of the current directory for delete */
 
@@ -29,6 +29,7 @@ typedef struct tree_entry
     unsigned int scanned:1;     /* Flag: childs scanned or not */
     struct tree_entry *next;    /* Next item in the list */
     struct tree_entry *prev;    /* Previous item in the list */
+    GSequenceIter *order_iter;  /* Position in the ordered index */
 } tree_entry;
 
 struct TreeStore
@@ -38,6 +39,8 @@ struct TreeStore
     tree_entry *check_start;    /* Start of checked subdirectories */
     vfs_path_t *check_name;
     GList *add_queue_vpath;     /* List of vfs_path_t objects of added directories */
+    GSequence *order;           /* Entries in the order of the list */
+    GHashTable *paths;          /* Path string -> entry */
     unsigned int loaded:1;
     unsigned int dirty:1;
 };
@@ -52,6 +55,7 @@ int tree_store_save (void);
 void tree_store_remove_entry (const vfs_path_t * name_vpath);
 tree_entry *tree_store_start_check (const vfs_path_t * vpath);
 void tree_store_mark_checked (const char *subname);
+void tree_store_add_subdir (const vfs_path_t * vpath, const char *subname);
 void tree_store_end_check (void);
 tree_entry *tree_store_whereis (const vfs_path_t * name);
 tree_entry *tree_store_rescan (const vfs_path_t * vpath);
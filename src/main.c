@@ -57,6 +57,7 @@
 
 #include "filemanager/midnight.h"       /* current_panel */
 #include "filemanager/treestore.h"      /* tree_store_save */
+#include "filemanager/dirsize.h"        /* dir_size_cache_done() */
 #include "filemanager/layout.h" /* command_prompt */
 #include "filemanager/ext.h"    /* flush_extension_file() */
 #include "filemanager/command.h"        /* cmdline */
@@ -464,6 +465,7 @@ main (int argc, char *argv[])
 
     /* Save the tree store */
     (void) tree_store_save ();
+    dir_size_cache_done ();
 
     free_keymap_defs ();
 
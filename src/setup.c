@@ -175,6 +175,15 @@ int verbose = 1;
  */
 int file_op_compute_totals = 1;
 
+/* If set, sizes of local directories are cached between scans */
+int cache_dir_sizes = 0;
+
+/* Number of background jobs running on the same device at once, 0 means no limit */
+int background_jobs_per_device = 1;
+
+/* Speed limit of copy and move operations in KiB/s, 0 means no limit */
+int copy_speed_limit = 0;
+
 /* If true use the internal viewer */
 int use_internal_view = 1;
 /* If set, use the builtin editor */
@@ -310,11 +319,17 @@ static const struct
     { "max_dirt_limit", &mcview_max_dirt_limit },
     { "use_file_to_guess_type", &use_file_to_check_type },
     { "alternate_plus_minus", &mc_global.tty.alternate_plus_minus },
+    { "screen_max_fps", &mc_global.tty.max_fps },
     { "only_leading_plus_minus", &only_leading_plus_minus },
     { "show_output_starts_shell", &output_starts_shell },
     { "xtree_mode", &xtree_mode },
     { "num_history_items_recorded", &num_history_items_recorded },
     { "file_op_compute_totals", &file_op_compute_totals },
+    { "cache_dir_sizes", &cache_dir_sizes },
+    { "copy_speed_limit", &copy_speed_limit },
+#ifdef ENABLE_BACKGROUND
+    { "background_jobs_per_device", &background_jobs_per_device },
+#endif
     { "classic_progressbar", &classic_progressbar},
 #ifdef ENABLE_VFS
     { "vfs_timeout", &vfs_timeout },
@@ -255,8 +255,7 @@ mcview_done (WView * view)
     if (mc_global.mc_run_mode == MC_RUN_VIEWER && view->dir != NULL)
     {
         /* mcviewer is the owner of file list */
-        dir_list_clean (view->dir);
-        g_free (view->dir->list);
+        dir_list_free_list (view->dir);
         g_free (view->dir_idx);
         g_free (view->dir);
     }
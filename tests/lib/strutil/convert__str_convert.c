@@ -0,0 +1,153 @@
+/*
+   lib/strutil - tests for conversion of strings from single-byte encodings.
+
+   Copyright (C) 2015
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/lib/strutil"
+
+#include "tests/mctest.h"
+
+#include "lib/strutil.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Before */
+static void
+setup (void)
+{
+    str_init_strings ("UTF-8");
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    str_uninit_strings ();
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @DataSource("str_convert_test_ds") */
+/* *INDENT-OFF* */
+static const struct str_convert_test_ds
+{
+    const char *encoding;
+    const char *input;
+    const char *expected_result;
+} str_convert_test_ds[] =
+{
+    {
+        "CP1251",
+        "\xc0\xc1 abc",
+        "\xd0\x90\xd0\x91 abc"
+    },
+    {
+        /* iconv keeps letters to compose them with the following points */
+        "CP1255",
+        "\xe0\xe1\xe2",
+        "\xd7\x90\xd7\x91\xd7\x92"
+    },
+    {
+        /* iconv keeps letters to compose them with the following tone marks */
+        "CP1258",
+        "Vi\xeat",
+        "Vi\xc3\xaat"
+    },
+    {
+        /* letter and tone mark are composed to one character */
+        "CP1258",
+        "a\xec",
+        "\xc3\xa1"
+    },
+    {
+        "TCVN5712-1",
+        "abc",
+        "abc"
+    }
+};
+/* *INDENT-ON* */
+
+/* @Test(dataSource = "str_convert_test_ds") */
+/* *INDENT-OFF* */
+START_TEST (str_convert_test)
+/* *INDENT-ON* */
+{
+    /* given */
+    const struct str_convert_test_ds *data = &str_convert_test_ds[_i];
+    GIConv conv;
+    GString *actual_result;
+    int i;
+
+    conv = str_crt_conv_from (data->encoding);
+    if (conv == INVALID_CONV)
+        return;                 /* encoding is not supported by iconv */
+
+    /* the first conversion builds table of converter, the second one uses it */
+    for (i = 0; i < 2; i++)
+    {
+        estr_t actual_state;
+
+        actual_result = g_string_new ("");
+
+        /* when */
+        actual_state = str_convert (conv, data->input, actual_result);
+
+        /* then */
+        fail_unless (actual_state == ESTR_SUCCESS, "%s: conversion failed", data->encoding);
+        mctest_assert_str_eq (actual_result->str, data->expected_result);
+
+        g_string_free (actual_result, TRUE);
+    }
+
+    str_close_conv (conv);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    int number_failed;
+
+    Suite *s = suite_create (TEST_SUITE_NAME);
+    TCase *tc_core = tcase_create ("Core");
+    SRunner *sr;
+
+    tcase_add_checked_fixture (tc_core, setup, teardown);
+
+    /* Add new tests here: *************** */
+    tcase_add_loop_test (tc_core, str_convert_test, 0, G_N_ELEMENTS (str_convert_test_ds));
+    /* *********************************** */
+
+    suite_add_tcase (s, tc_core);
+    sr = srunner_create (s);
+    srunner_set_log (sr, "convert__str_convert.log");
+    srunner_run_all (sr, CK_ENV);
+    number_failed = srunner_ntests_failed (sr);
+    srunner_free (sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,229 @@
+/*
+   lib/strutil - tests for UTF-8 width and validation functions.
+
+   Copyright (C) 2015
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/lib/strutil"
+
+#include "tests/mctest.h"
+
+#include "lib/strutil.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Before */
+static void
+setup (void)
+{
+    str_init_strings ("UTF-8");
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    str_uninit_strings ();
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @DataSource("str_term_width_test_ds") */
+/* *INDENT-OFF* */
+static const struct str_term_width_test_ds
+{
+    const char *input;
+    int expected_width;
+    const char *expected_form;
+    gboolean valid;
+} str_term_width_test_ds[] =
+{
+    {
+        "",
+        0,
+        "",
+        TRUE
+    },
+    {
+        "abc",
+        3,
+        "abc",
+        TRUE
+    },
+    {
+        /* longer than several words */
+        "The quick brown fox jumps over the lazy dog 0123456789",
+        54,
+        "The quick brown fox jumps over the lazy dog 0123456789",
+        TRUE
+    },
+    {
+        /* control characters in the middle of word */
+        "abcdefgh\tijklmnop\x7fqrst",
+        22,
+        "abcdefgh.ijklmnop.qrst",
+        TRUE
+    },
+    {
+        /* wide characters */
+        "ab\xe4\xb8\xad\xe6\x96\x87" "cd",
+        8,
+        "ab\xe4\xb8\xad\xe6\x96\x87" "cd",
+        TRUE
+    },
+    {
+        /* combining mark */
+        "e\xcc\x81tude",
+        5,
+        "\xc3\xa9tude",
+        TRUE
+    },
+    {
+        /* cyrillic after long ASCII prefix */
+        "0123456789abcdef\xd0\xb6\xd1\x83\xd0\xba",
+        19,
+        "0123456789abcdef\xd0\xb6\xd1\x83\xd0\xba",
+        TRUE
+    },
+    {
+        /* invalid byte */
+        "0123456789abcdef\xff",
+        17,
+        "0123456789abcdef\xef\xbf\xbd",
+        FALSE
+    }
+};
+/* *INDENT-ON* */
+
+/* @Test(dataSource = "str_term_width_test_ds") */
+/* *INDENT-OFF* */
+START_TEST (str_term_width_test)
+/* *INDENT-ON* */
+{
+    /* given */
+    const struct str_term_width_test_ds *data = &str_term_width_test_ds[_i];
+    int actual_width1, actual_width2;
+    const char *actual_form;
+    gboolean actual_valid;
+
+    /* when */
+    actual_width1 = str_term_width1 (data->input);
+    actual_width2 = str_term_width2 (data->input, (size_t) (-1));
+    actual_form = str_term_form (data->input);
+    actual_valid = str_is_valid_string (data->input);
+
+    /* then */
+    fail_unless (actual_width1 == data->expected_width,
+                 "width: actual (%d) not equal to\nexpected (%d)", actual_width1,
+                 data->expected_width);
+    fail_unless (actual_width2 == data->expected_width,
+                 "width2: actual (%d) not equal to\nexpected (%d)", actual_width2,
+                 data->expected_width);
+    mctest_assert_str_eq (actual_form, data->expected_form);
+    fail_unless (actual_valid == data->valid, "validity: actual (%d) not equal to\nexpected (%d)",
+                 actual_valid, data->valid);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @DataSource("str_fit_to_term_test_ds") */
+/* *INDENT-OFF* */
+static const struct str_fit_to_term_test_ds
+{
+    const char *input;
+    int width;
+    const char *expected_result;
+} str_fit_to_term_test_ds[] =
+{
+    {
+        "abcdefghijklmnopqrstuvwxyz",
+        10,
+        "abcdefghij"
+    },
+    {
+        "abc",
+        6,
+        "abc   "
+    },
+    {
+        "ab\xe4\xb8\xad\xe6\x96\x87" "cd",
+        5,
+        "ab\xe4\xb8\xad "
+    },
+    {
+        "e\xcc\x81tude",
+        3,
+        "\xc3\xa9tu"
+    }
+};
+/* *INDENT-ON* */
+
+/* @Test(dataSource = "str_fit_to_term_test_ds") */
+/* *INDENT-OFF* */
+START_TEST (str_fit_to_term_test)
+/* *INDENT-ON* */
+{
+    /* given */
+    const struct str_fit_to_term_test_ds *data = &str_fit_to_term_test_ds[_i];
+    const char *actual_result;
+
+    /* when */
+    actual_result = str_fit_to_term (data->input, data->width, J_LEFT);
+
+    /* then */
+    mctest_assert_str_eq (actual_result, data->expected_result);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    int number_failed;
+
+    Suite *s = suite_create (TEST_SUITE_NAME);
+    TCase *tc_core = tcase_create ("Core");
+    SRunner *sr;
+
+    tcase_add_checked_fixture (tc_core, setup, teardown);
+
+    /* Add new tests here: *************** */
+    tcase_add_loop_test (tc_core, str_term_width_test, 0, G_N_ELEMENTS (str_term_width_test_ds));
+    tcase_add_loop_test (tc_core, str_fit_to_term_test, 0,
+                         G_N_ELEMENTS (str_fit_to_term_test_ds));
+    /* *********************************** */
+
+    suite_add_tcase (s, tc_core);
+    sr = srunner_create (s);
+    srunner_set_log (sr, "utf8__str_term_width.log");
+    srunner_run_all (sr, CK_ENV);
+    number_failed = srunner_ntests_failed (sr);
+    srunner_free (sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* --------------------------------------------------------------------------------------------- */